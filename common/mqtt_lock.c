@@ -0,0 +1,29 @@
+/*
+ * bsp_mqtt 客户端锁 (说明见 mqtt_lock.h)
+ */
+#include "cmsis_os2.h"
+
+#include "mqtt_lock.h"
+
+static osMutexId_t g_mqttLock;
+
+int MqttLock_Init(void)
+{
+    if (g_mqttLock != NULL)
+        return 0;
+    osMutexAttr_t attr = {0};
+    attr.name = "mqtt_client";
+    attr.attr_bits = osMutexRecursive | osMutexPrioInherit;
+    g_mqttLock = osMutexNew(&attr);
+    return g_mqttLock != NULL ? 0 : -1;
+}
+
+void MqttLock_Acquire(void)
+{
+    osMutexAcquire(g_mqttLock, osWaitForever);
+}
+
+void MqttLock_Release(void)
+{
+    osMutexRelease(g_mqttLock);
+}
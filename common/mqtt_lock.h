@@ -0,0 +1,24 @@
+/*
+ * bsp_mqtt 客户端锁 (雷达与各实验共用)
+ *
+ * bsp_mqtt 是同步客户端，没有自己的锁：接收线程在 MQTTClient_sub() 里可能正在发 PINGREQ，
+ * 发送线程同时 MQTTClient_pub()，两边的报文就会在同一条 TCP 流里交错，服务器只能断开连接。
+ * 这里给整个镜像一把锁，所有 MQTTClient_* 调用 (connect/init/subscribe/pub/sub/disconnect)
+ * 都要在锁内进行；common 下的 mqtt_rx / mqtt_pubq / net_service 已经这样做，
+ * 应用代码不要再直接调用 MQTTClient_*。
+ *
+ * 锁是递归的：订阅回调在 MQTTClient_sub() 里 (已持锁) 执行，回调里再发布不会死锁。
+ *
+ *   // 应用入口 (SYS_RUN) 里，创建任何网络线程之前：
+ *   MqttLock_Init();
+ */
+#ifndef MQTT_LOCK_H
+#define MQTT_LOCK_H
+
+/* 重复调用只创建一次；须在初始化阶段 (单线程) 调用。成功返回 0 */
+int MqttLock_Init(void);
+
+void MqttLock_Acquire(void);
+void MqttLock_Release(void);
+
+#endif
@@ -0,0 +1,290 @@
+/*
+ * MQTT 非阻塞发布队列 (说明见 mqtt_pubq.h)
+ */
+#include <string.h>
+
+#include "cmsis_os2.h"
+#include "hi_time.h"
+#include "bsp_mqtt.h"
+
+#include "mqtt_lock.h"
+#include "mqtt_pubq.h"
+
+#define PUBQ_EVT_DATA 0x1
+#define PUBQ_F_DEAD 0x80 // 链上前面的消息已丢，本条发出去也没用，轮到时直接回收
+
+/* 队列里的一条消息：主题 (含结尾 '\0') 紧跟负载 */
+typedef struct
+{
+    uint16_t len;
+    uint8_t topicLen; // 不含 '\0'
+    uint8_t flags;
+    uint32_t topicHash;
+    uint32_t enqueueUs;
+} PubqEntry_t;
+
+/* 消息字节环 + 消息描述环，均由 g_pubqLock 保护 */
+static uint8_t g_pubqBuf[MQTT_PUBQ_BYTES];
+static uint32_t g_pubqHead, g_pubqTail, g_pubqUsed;
+static PubqEntry_t g_pubqEntry[MQTT_PUBQ_DEPTH];
+static uint32_t g_pubqFirst, g_pubqCount;
+static MqttPubqPolicy_t g_pubqPolicy = MQTT_PUBQ_DROP_OLDEST;
+static MqttPubqStats_t g_pubqStats;
+static uint32_t g_pubqBroken[MQTT_PUBQ_CHAIN_TOPICS]; // 链已断的主题 (哈希)，0 为空
+static uint32_t g_pubqBrokenNext;
+static volatile uint8_t g_pubqOnline;
+static volatile uint32_t g_pubqSession; // 每次 SetOnline(1) 加一，旧会话上的失败不影响新会话
+
+static osMutexId_t g_pubqLock;
+static osEventFlagsId_t g_pubqEvent;
+
+static void Pubq_Put(const uint8_t *src, uint32_t len)
+{
+    uint32_t first = MQTT_PUBQ_BYTES - g_pubqHead;
+    if (first > len)
+        first = len;
+    memcpy(g_pubqBuf + g_pubqHead, src, first);
+    memcpy(g_pubqBuf, src + first, len - first);
+    g_pubqHead = (g_pubqHead + len) % MQTT_PUBQ_BYTES;
+    g_pubqUsed += len;
+}
+
+/* 取出最早的一条消息；dst 为 NULL 时直接丢弃 */
+static PubqEntry_t Pubq_Take(uint8_t *dst)
+{
+    PubqEntry_t e = g_pubqEntry[g_pubqFirst];
+    if (dst != NULL)
+    {
+        uint32_t first = MQTT_PUBQ_BYTES - g_pubqTail;
+        if (first > e.len)
+            first = e.len;
+        memcpy(dst, g_pubqBuf + g_pubqTail, first);
+        memcpy(dst + first, g_pubqBuf, e.len - first);
+    }
+    g_pubqTail = (g_pubqTail + e.len) % MQTT_PUBQ_BYTES;
+    g_pubqUsed -= e.len;
+    g_pubqFirst = (g_pubqFirst + 1) % MQTT_PUBQ_DEPTH;
+    g_pubqCount--;
+    g_pubqStats.queuedBytes = g_pubqUsed;
+    return e;
+}
+
+/* FNV-1a，0 留作空槽 */
+static uint32_t Pubq_Hash(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s)
+    {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+static int Pubq_ChainSlot(uint32_t hash)
+{
+    for (int i = 0; i < MQTT_PUBQ_CHAIN_TOPICS; i++)
+    {
+        if (g_pubqBroken[i] == hash)
+            return i;
+    }
+    return -1;
+}
+
+/* 主题 hash 的一条消息被丢掉：队列里紧随其后的链式消息都依赖它，一并作废，
+ * 直到遇到该主题的下一条非链式消息 (链从那里重新开始)；没遇到就记下链已断，
+ * 之后新来的链式消息也拒收，等调用者发非链式消息接上 */
+static void Pubq_BreakChain(uint32_t hash)
+{
+    for (uint32_t n = 0; n < g_pubqCount; n++)
+    {
+        PubqEntry_t *e = &g_pubqEntry[(g_pubqFirst + n) % MQTT_PUBQ_DEPTH];
+        if (e->topicHash != hash || (e->flags & PUBQ_F_DEAD))
+            continue;
+        if (!(e->flags & MQTT_PUBQ_F_CHAIN))
+            return;
+        e->flags |= PUBQ_F_DEAD;
+        g_pubqStats.purged++;
+    }
+    if (Pubq_ChainSlot(hash) < 0)
+    {
+        g_pubqBroken[g_pubqBrokenNext] = hash;
+        g_pubqBrokenNext = (g_pubqBrokenNext + 1) % MQTT_PUBQ_CHAIN_TOPICS;
+    }
+}
+
+/* 发送线程：出锁取出最早的一条消息，在客户端锁内 MQTTClient_pub()。
+ * 每条消息单独一次 MQTTClient_pub()：bsp_mqtt 不提供把已编码的 PUBLISH 报文直接写 socket 的接口，
+ * 不做多条合并成一次写。发送失败就把会话标为断开，消息留在手里，会话恢复后重发这一条 */
+static void MqttPubq_Task(void *arg)
+{
+    (void)arg;
+    static uint8_t msg[MQTT_PUBQ_MSG_BYTES];
+    PubqEntry_t e;
+    uint8_t holding = 0;
+
+    while (1)
+    {
+        osEventFlagsWait(g_pubqEvent, PUBQ_EVT_DATA, osFlagsWaitAny, osWaitForever);
+        while (g_pubqOnline)
+        {
+            if (!holding)
+            {
+                osMutexAcquire(g_pubqLock, osWaitForever);
+                while (g_pubqCount > 0 && (g_pubqEntry[g_pubqFirst].flags & PUBQ_F_DEAD))
+                    Pubq_Take(NULL);
+                if (g_pubqCount > 0)
+                {
+                    e = Pubq_Take(msg);
+                    holding = 1;
+                }
+                osMutexRelease(g_pubqLock);
+                if (!holding)
+                    break;
+            }
+
+            uint32_t session = g_pubqSession;
+            MqttLock_Acquire();
+            int ret = MQTTClient_pub((char *)msg, msg + e.topicLen + 1, e.len - e.topicLen - 1U);
+            MqttLock_Release();
+            uint32_t now = hi_get_us();
+
+            osMutexAcquire(g_pubqLock, osWaitForever);
+            MqttPubqStats_t *s = &g_pubqStats;
+            if (ret != 0)
+            {
+                s->sendErrors++;
+                if (session == g_pubqSession)
+                    g_pubqOnline = 0;
+            }
+            else
+            {
+                s->sent++;
+                uint32_t latency = now - e.enqueueUs;
+                s->latencySumUs += latency;
+                if (latency > s->latencyMaxUs)
+                    s->latencyMaxUs = latency;
+                holding = 0;
+            }
+            osMutexRelease(g_pubqLock);
+        }
+    }
+}
+
+int MqttPubq_Start(MqttPubqPolicy_t policy)
+{
+    if (g_pubqLock != NULL)
+        return 0;
+    g_pubqPolicy = policy;
+    g_pubqLock = osMutexNew(NULL);
+    g_pubqEvent = osEventFlagsNew(NULL);
+    if (g_pubqLock == NULL || g_pubqEvent == NULL)
+        return -1;
+
+    osThreadAttr_t attr = {0};
+    attr.name = "MQTT_PubTask";
+    attr.stack_size = 1024;
+    attr.priority = MQTT_PUBQ_TASK_PRIO;
+    return osThreadNew(MqttPubq_Task, NULL, &attr) != NULL ? 0 : -1;
+}
+
+void MqttPubq_SetPolicy(MqttPubqPolicy_t policy)
+{
+    g_pubqPolicy = policy;
+}
+
+void MqttPubq_SetOnline(int online)
+{
+    if (online)
+        g_pubqSession++;
+    g_pubqOnline = online ? 1 : 0;
+    if (online && g_pubqEvent != NULL)
+        osEventFlagsSet(g_pubqEvent, PUBQ_EVT_DATA); // 补发断开期间积下的消息
+}
+
+int MqttPubq_IsOnline(void)
+{
+    return g_pubqOnline;
+}
+
+int MqttPubq_Publish(const char *topic, const uint8_t *payload, size_t len, uint8_t flags)
+{
+    uint32_t topicLen = (uint32_t)strlen(topic);
+    uint32_t msgLen = topicLen + 1 + (uint32_t)len;
+    uint32_t hash = Pubq_Hash(topic);
+    flags &= MQTT_PUBQ_F_CHAIN;
+
+    if (g_pubqLock == NULL)
+        return -1;
+    osMutexAcquire(g_pubqLock, osWaitForever);
+    MqttPubqStats_t *s = &g_pubqStats;
+    int dropped = 0;
+    if (topicLen > 0xFF || msgLen > MQTT_PUBQ_MSG_BYTES)
+    {
+        s->droppedNewest++;
+        if (flags & MQTT_PUBQ_F_CHAIN)
+            Pubq_BreakChain(hash);
+        osMutexRelease(g_pubqLock);
+        return -1;
+    }
+    while (g_pubqCount == MQTT_PUBQ_DEPTH || g_pubqUsed + msgLen > MQTT_PUBQ_BYTES)
+    {
+        if (g_pubqPolicy == MQTT_PUBQ_DROP_NEWEST && !(g_pubqEntry[g_pubqFirst].flags & PUBQ_F_DEAD))
+        {
+            s->droppedNewest++;
+            if (flags & MQTT_PUBQ_F_CHAIN)
+                Pubq_BreakChain(hash);
+            osMutexRelease(g_pubqLock);
+            return -1;
+        }
+        PubqEntry_t e = Pubq_Take(NULL);
+        if (e.flags & PUBQ_F_DEAD)
+            continue; // 作废的消息先回收，已计入 purged
+        s->droppedOldest++;
+        dropped++;
+        Pubq_BreakChain(e.topicHash);
+    }
+
+    int slot = Pubq_ChainSlot(hash);
+    if (slot >= 0)
+    {
+        if (flags & MQTT_PUBQ_F_CHAIN)
+        {
+            // 链已断：这条依赖的上一条没送出去，发了对端也解不出来
+            s->purged++;
+            osMutexRelease(g_pubqLock);
+            return -1;
+        }
+        g_pubqBroken[slot] = 0;
+    }
+
+    Pubq_Put((const uint8_t *)topic, topicLen + 1);
+    Pubq_Put(payload, (uint32_t)len);
+    PubqEntry_t *e = &g_pubqEntry[(g_pubqFirst + g_pubqCount) % MQTT_PUBQ_DEPTH];
+    e->len = (uint16_t)msgLen;
+    e->topicLen = (uint8_t)topicLen;
+    e->flags = flags;
+    e->topicHash = hash;
+    e->enqueueUs = hi_get_us();
+    g_pubqCount++;
+    s->queued++;
+    s->queuedBytes = g_pubqUsed;
+    if (g_pubqUsed > s->queuedBytesMax)
+        s->queuedBytesMax = g_pubqUsed;
+    osMutexRelease(g_pubqLock);
+
+    osEventFlagsSet(g_pubqEvent, PUBQ_EVT_DATA);
+    return dropped;
+}
+
+void MqttPubq_GetStats(MqttPubqStats_t *out)
+{
+    if (g_pubqLock == NULL)
+    {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    osMutexAcquire(g_pubqLock, osWaitForever);
+    memcpy(out, &g_pubqStats, sizeof(*out));
+    osMutexRelease(g_pubqLock);
+}
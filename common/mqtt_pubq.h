@@ -0,0 +1,83 @@
+/*
+ * MQTT 非阻塞发布队列 (建立在 bsp_mqtt 之上，雷达与各实验共用)
+ *
+ * MQTTClient_pub() 在调用者线程里同步写 socket，TCP 窗口一满，产生数据的任务就跟着卡住。
+ * 这里把主题和负载在调用者线程里拷进有界队列就返回，由唯一的发送线程取出，
+ * 在 mqtt_lock 内逐条 MQTTClient_pub()，与接收线程的 MQTTClient_sub() (含保活) 互斥，
+ * 同一条 TCP 流上不会有两个写者。每条消息仍是一次 MQTTClient_pub()，不合并成一次 socket 写。入队只做一次拷贝，不碰网络；队列满时按策略丢最旧或丢最新的消息。
+ *
+ * 会话是否可用由网络服务告诉队列 (MqttPubq_SetOnline)。发送失败时队列把自己标为断开，
+ * 停止发送但不丢消息：没发出去的留在发送线程手里，新消息照常入队 (满了按策略丢)，
+ * 网络服务发现后重连，再标为可用，接着从失败的那条发。
+ *
+ *   // 初始化阶段 (MqttLock_Init 之后)：
+ *   MqttPubq_Start(MQTT_PUBQ_DROP_OLDEST);
+ *   // 会话建立后 / 断开时：
+ *   MqttPubq_SetOnline(1);
+ *   // 任意线程：
+ *   MqttPubq_Publish(topic, payload, len, 0);
+ *
+ * 差分编码的消息 (如雷达的差分帧) 要依赖同一主题的上一条才能解码，入队时带 MQTT_PUBQ_F_CHAIN。
+ * 某条消息被丢掉后，队列里紧随其后的同主题链式消息一并作废 (不再占用上行带宽)，
+ * 之后新来的链式消息也拒收 (返回 -1)，直到该主题来一条不带标志的消息 (关键帧) 重新开始。
+ */
+#ifndef MQTT_PUBQ_H
+#define MQTT_PUBQ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef MQTT_PUBQ_BYTES
+#define MQTT_PUBQ_BYTES 4096 // 排队消息的总字节上限 (主题 + 负载)
+#endif
+#ifndef MQTT_PUBQ_DEPTH
+#define MQTT_PUBQ_DEPTH 16 // 排队消息的条数上限
+#endif
+#ifndef MQTT_PUBQ_MSG_BYTES
+#define MQTT_PUBQ_MSG_BYTES 1460 // 单条消息的上限 (主题 + 负载)，更长的拒收
+#endif
+#ifndef MQTT_PUBQ_CHAIN_TOPICS
+#define MQTT_PUBQ_CHAIN_TOPICS 4 // 同时记录 "链已断" 的主题数
+#endif
+#ifndef MQTT_PUBQ_TASK_PRIO
+#define MQTT_PUBQ_TASK_PRIO osPriorityNormal
+#endif
+
+typedef enum
+{
+    MQTT_PUBQ_DROP_OLDEST, // 丢掉最早入队的消息给新消息腾位置 (传感器数据，只关心最新值)
+    MQTT_PUBQ_DROP_NEWEST, // 拒绝新消息 (已入队的按序送达)
+} MqttPubqPolicy_t;
+
+#define MQTT_PUBQ_F_CHAIN 0x01 // 本消息依赖同主题的上一条 (差分)，上一条丢了本条也作废
+
+typedef struct
+{
+    uint32_t queued;         // 入队消息数
+    uint32_t sent;           // MQTTClient_pub 成功的消息数
+    uint32_t droppedOldest;  // 为新消息腾位置丢掉的旧消息
+    uint32_t droppedNewest;  // 被拒绝的新消息 (含超长消息)
+    uint32_t sendErrors;     // 发送失败次数 (每次都把会话标为断开，消息留待重连后重发)
+    uint32_t purged;         // 链上前面的消息丢了而作废/拒收的链式消息
+    uint32_t queuedBytes;    // 当前排队字节
+    uint32_t queuedBytesMax; // 排队字节峰值
+    uint64_t latencySumUs;   // 入队 → MQTTClient_pub 返回
+    uint32_t latencyMaxUs;
+} MqttPubqStats_t;
+
+/* 创建发送线程，成功返回 0；须在初始化阶段调用，重复调用直接返回 0。启动后处于断开状态 */
+int MqttPubq_Start(MqttPubqPolicy_t policy);
+
+void MqttPubq_SetPolicy(MqttPubqPolicy_t policy);
+
+/* 会话建立后置 1 开始发送；断开时置 0 (发送失败时队列也会自己置 0) */
+void MqttPubq_SetOnline(int online);
+int MqttPubq_IsOnline(void);
+
+/* 不阻塞在网络上。flags 为 0 或 MQTT_PUBQ_F_CHAIN。
+ * 返回为腾位置丢掉的旧消息数 (>= 0)，本消息被拒绝 (队列满、超长或链已断) 时返回 -1 */
+int MqttPubq_Publish(const char *topic, const uint8_t *payload, size_t len, uint8_t flags);
+
+void MqttPubq_GetStats(MqttPubqStats_t *out);
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * MQTT 事件驱动接收 (说明见 mqtt_rx.h)
+ */
+#include <string.h>
+#include <unistd.h>
+
+#include "bsp_mqtt.h"
+
+#include "mqtt_lock.h"
+#include "mqtt_rx.h"
+
+#if MQTT_RX_SELECT
+#include "lwip/sockets.h"
+#endif
+
+static MqttRxStats_t g_mqttRxStats;
+
+#if MQTT_RX_SELECT
+int MqttRx_RunOnce(void)
+{
+    int sock = MQTTClient_getSocket();
+    if (sock < 0)
+    {
+        g_mqttRxStats.retries++;
+        return -1;
+    }
+
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(sock, &readSet);
+    struct timeval timeout = {MQTT_RX_IDLE_TIMEOUT_S, 0};
+    int ret = lwip_select(sock + 1, &readSet, NULL, NULL, &timeout);
+    if (ret < 0)
+    {
+        g_mqttRxStats.errors++;
+        return -1;
+    }
+
+    // 可读：立即读包并分发回调；超时：调用一次让 bsp_mqtt 处理保活
+    MqttLock_Acquire();
+    int subRet = MQTTClient_sub();
+    MqttLock_Release();
+    if (ret == 0)
+    {
+        g_mqttRxStats.timeouts++;
+        return 0;
+    }
+    g_mqttRxStats.readable++;
+    if (subRet != 0)
+    {
+        // 可读却读不出包：对端已关闭或连接出错
+        g_mqttRxStats.errors++;
+        return -1;
+    }
+    return 0;
+}
+#else
+int MqttRx_RunOnce(void)
+{
+    // 没有 socket 可等：与原接收线程相同，读一次包 (含保活) 后固定间隔再读
+    MqttLock_Acquire();
+    int subRet = MQTTClient_sub();
+    MqttLock_Release();
+    g_mqttRxStats.polls++;
+    usleep(MQTT_RX_POLL_MS * 1000);
+    if (subRet != 0)
+    {
+        g_mqttRxStats.errors++;
+        return -1;
+    }
+    return 0;
+}
+#endif
+
+void MqttRx_Loop(void)
+{
+    while (1)
+    {
+        if (MqttRx_RunOnce() != 0)
+            usleep(MQTT_RX_RETRY_MS * 1000); // 避免空转
+    }
+}
+
+void MqttRx_GetStats(MqttRxStats_t *out)
+{
+    memcpy(out, &g_mqttRxStats, sizeof(*out));
+}
@@ -0,0 +1,56 @@
+/*
+ * MQTT 事件驱动接收 (建立在 bsp_mqtt 之上，雷达与各实验共用)
+ *
+ * 原来的接收线程是 MQTTClient_sub(); usleep(200ms) 轮询：每条控制指令平均多等 100 ms
+ * (最坏 200 ms)，空闲时每秒也要醒 5 次。这里改为在 bsp_mqtt 的 socket 上 lwip_select()
+ * 阻塞等待，数据一到立即调用 MQTTClient_sub() 读包并分发回调；
+ * 没有数据时每半个保活周期醒一次，照旧调用一次 MQTTClient_sub() 让 bsp_mqtt 处理保活。
+ *
+ * select 方式依赖 bsp_mqtt 导出内部 socket：int MQTTClient_getSocket(void) (未连接时返回 -1)，
+ * 现有的 bsp_mqtt 没有这个接口，所以默认 MQTT_RX_SELECT 为 0，仍按原来的方式每 MQTT_RX_POLL_MS
+ * 轮询一次 MQTTClient_sub()；给 bsp_mqtt 加上该接口后再以 -DMQTT_RX_SELECT=1 编译 (主机仿真即如此)。
+ * 两种方式下 MQTTClient_sub() 都在 mqtt_lock 内调用，select 等待与轮询间隔期间不持锁。
+ * 工程的 BUILD.gn 需加入 common/mqtt_rx.c 并把 common 目录加入 include_dirs。
+ *
+ *   // 原来的接收线程函数体整个换成：
+ *   MqttRx_Loop();
+ */
+#ifndef MQTT_RX_H
+#define MQTT_RX_H
+
+#include <stdint.h>
+
+// 须与 bsp_mqtt 中 MQTTClient_init 使用的 keepAliveInterval 一致
+#ifndef MQTT_RX_SELECT
+#define MQTT_RX_SELECT 0 // 1: 在 socket 上 select 等待 (需要 MQTTClient_getSocket)；0: 定时轮询
+#endif
+#ifndef MQTT_RX_POLL_MS
+#define MQTT_RX_POLL_MS 200 // 轮询方式的间隔
+#endif
+#ifndef MQTT_RX_KEEPALIVE_S
+#define MQTT_RX_KEEPALIVE_S 60
+#endif
+#define MQTT_RX_IDLE_TIMEOUT_S (MQTT_RX_KEEPALIVE_S / 2) // 空闲唤醒间隔：保活周期内至少两次
+#ifndef MQTT_RX_RETRY_MS
+#define MQTT_RX_RETRY_MS 1000 // 未连接或 socket 出错时的重试间隔
+#endif
+
+typedef struct
+{
+    uint32_t readable; // socket 可读后读包的次数
+    uint32_t timeouts; // 空闲超时唤醒次数
+    uint32_t polls;    // 轮询方式下调用 MQTTClient_sub() 的次数
+    uint32_t errors;   // select 出错或读包失败
+    uint32_t retries;  // socket 不可用时的等待次数
+} MqttRxStats_t;
+
+/* 接收线程主循环，永不返回 */
+void MqttRx_Loop(void);
+
+/* 只等一次 (select 方式：可读即分发，否则等到空闲超时；轮询方式：读一次包再睡 MQTT_RX_POLL_MS)，
+ * 供有自己主循环的线程调用。未连接、select 出错或读包失败时返回 -1，由调用者决定重连或等待 */
+int MqttRx_RunOnce(void);
+
+void MqttRx_GetStats(MqttRxStats_t *out);
+
+#endif
@@ -0,0 +1,335 @@
+/*
+ * 网络服务 (说明见 net_service.h)
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cmsis_os2.h"
+#include "bsp_wifi.h"
+#include "bsp_mqtt.h"
+
+#include "mqtt_lock.h"
+#include "mqtt_rx.h"
+#include "net_service.h"
+
+#define NET_EVT_UP 0x1
+#define NET_EVT_FAILED 0x2
+
+/* 路由表只增不删，所以线性探测遇到空槽即可判定不存在。
+ * 注册方先填好主题和处理函数再置 used，服务线程查表不需要加锁；
+ * 注册应在各模块的初始化流程里完成，不要多个线程同时注册。 */
+typedef struct
+{
+    volatile uint8_t used;
+    volatile uint8_t subscribed;
+    uint32_t hash;
+    char topic[NET_TOPIC_MAX];
+    volatile NetTopicHandler_t handler;
+} NetRoute_t;
+
+static NetRoute_t g_netRoutes[NET_ROUTE_SLOTS];
+static NetServiceStats_t g_netStats;
+static NetServiceConfig_t g_netCfg;
+static volatile NetState_t g_netState = NET_STATE_IDLE;
+static osEventFlagsId_t g_netEvent;
+static uint8_t g_netStarted;
+
+/* FNV-1a */
+static uint32_t Net_Hash(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s)
+    {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* 返回主题所在的槽；不存在时返回它应插入的空槽，表满返回 -1 */
+static int Net_Probe(const char *topic, uint32_t hash, uint32_t *probes)
+{
+    uint32_t i = hash & (NET_ROUTE_SLOTS - 1);
+    for (uint32_t n = 1; n <= NET_ROUTE_SLOTS; n++, i = (i + 1) & (NET_ROUTE_SLOTS - 1))
+    {
+        NetRoute_t *r = &g_netRoutes[i];
+        if (!r->used || (r->hash == hash && strcmp(r->topic, topic) == 0))
+        {
+            if (probes != NULL)
+                *probes = n;
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* bsp_mqtt 的全局回调：按主题查表转给注册的模块 */
+static int8_t Net_Dispatch(unsigned char *topic, unsigned char *payload)
+{
+    uint32_t probes = 0;
+    int i = Net_Probe((const char *)topic, Net_Hash((const char *)topic), &probes);
+    if (probes > g_netStats.probeMax)
+        g_netStats.probeMax = probes;
+    if (i < 0 || !g_netRoutes[i].used)
+    {
+        g_netStats.unrouted++;
+        printf("[net] no handler for topic: %s\n", topic);
+        return -1;
+    }
+    g_netStats.routed++;
+    return g_netRoutes[i].handler(topic, payload);
+}
+
+static void Net_SubscribePending(void)
+{
+    for (int i = 0; i < NET_ROUTE_SLOTS; i++)
+    {
+        NetRoute_t *r = &g_netRoutes[i];
+        if (!r->used || r->subscribed)
+            continue;
+        MqttLock_Acquire();
+        int ret = MQTTClient_subscribe(r->topic);
+        MqttLock_Release();
+        if (ret == 0)
+        {
+            r->subscribed = 1;
+            printf("[net] subscribed: %s\n", r->topic);
+        }
+        else
+        {
+            printf("[net] subscribe failed: %s\n", r->topic);
+        }
+    }
+}
+
+/* 已从热点拿到 IP */
+static int Net_LinkUp(void)
+{
+    char *ip = WiFi_GetLocalIP();
+    return ip && strlen(ip) > 0 && strcmp(ip, "EC800M_4G") != 0 && strcmp(ip, "0.0.0.0") != 0;
+}
+
+static int Net_WaitIp(void)
+{
+    for (int i = 0; i < NET_WIFI_WAIT_S; i++)
+    {
+        if (Net_LinkUp())
+            return 0;
+        sleep(1);
+    }
+    return -1;
+}
+
+static int Net_ConnectMqtt(void)
+{
+    for (int retry = 0; retry < NET_MQTT_RETRY; retry++)
+    {
+        MqttLock_Acquire();
+        int ret = MQTTClient_connectServer(g_netCfg.serverIp, g_netCfg.serverPort);
+        if (ret == 0)
+            ret = MQTTClient_init((char *)g_netCfg.clientId, (char *)g_netCfg.userName, (char *)g_netCfg.userPassword);
+        MqttLock_Release();
+        if (ret == 0)
+        {
+            printf("[net] MQTT server connected\n");
+            return 0;
+        }
+        printf("[net] MQTT connect failed, retrying...\n");
+        sleep(NET_MQTT_RETRY_S);
+    }
+    return -1;
+}
+
+static void Net_Fail(NetState_t state)
+{
+    g_netState = state;
+    osEventFlagsSet(g_netEvent, NET_EVT_FAILED);
+    // 即使没有网络，也保持线程运行，防止系统Crash
+    while (1)
+        sleep(10);
+}
+
+/* 会话建立 (首次或重连后)：接上回调、订阅全部主题、放开发布队列 */
+static void Net_SessionUp(void)
+{
+    p_MQTTClient_sub_callback = &Net_Dispatch;
+    Net_SubscribePending();
+    MqttPubq_SetOnline(1);
+    g_netState = NET_STATE_UP;
+    osEventFlagsSet(g_netEvent, NET_EVT_UP);
+}
+
+/* 重连时 WiFi 已掉线 (热点重启、信号丢失)：重新连接热点直到拿到 IP。
+ * 与启动时不同，这里不进入失败状态，一直重试 */
+static void Net_RejoinWifi(void)
+{
+    g_netState = NET_STATE_WIFI;
+    g_netStats.wifiRejoins++;
+    printf("[net] WiFi link lost, reconnecting to %s...\n", g_netCfg.ssid);
+    while (1)
+    {
+        WifiErrorCode wifiRes = WiFi_connectHotspots(g_netCfg.ssid, g_netCfg.password);
+        if (wifiRes != WIFI_SUCCESS)
+            printf("[net] WiFi connect error: %d\n", wifiRes);
+        if (Net_WaitIp() == 0)
+            break;
+        printf("[net] WiFi still down, retrying...\n");
+    }
+    printf("[net] WiFi reconnected\n");
+    g_netState = NET_STATE_MQTT;
+}
+
+/* 读包失败或发布失败：关掉旧连接，先确认 WiFi 仍连着 (掉了就重连热点)，
+ * 再重连 MQTT 并重新订阅。期间发布队列只入队不发送 */
+static void Net_Reconnect(void)
+{
+    MqttPubq_SetOnline(0);
+    osEventFlagsClear(g_netEvent, NET_EVT_UP);
+    g_netState = NET_STATE_MQTT;
+    g_netStats.reconnects++;
+    printf("[net] MQTT session lost, reconnecting...\n");
+
+    MqttLock_Acquire();
+    MQTTClient_disconnect();
+    MqttLock_Release();
+    for (int i = 0; i < NET_ROUTE_SLOTS; i++)
+        g_netRoutes[i].subscribed = 0;
+    while (1)
+    {
+        if (!Net_LinkUp())
+            Net_RejoinWifi();
+        if (Net_ConnectMqtt() == 0)
+            break;
+        sleep(NET_MQTT_RETRY_S);
+    }
+    Net_SessionUp();
+}
+
+static void NetService_Task(void *arg)
+{
+    (void)arg;
+
+    g_netState = NET_STATE_WIFI;
+    printf("[net] connecting to WiFi: %s...\n", g_netCfg.ssid);
+    WifiErrorCode wifiRes = WiFi_connectHotspots(g_netCfg.ssid, g_netCfg.password);
+    if (wifiRes != WIFI_SUCCESS)
+        printf("[net] WiFi connect error: %d\n", wifiRes);
+    if (Net_WaitIp() != 0)
+    {
+        printf("[net] WiFi connection timeout!\n");
+        Net_Fail(NET_STATE_WIFI_FAILED);
+    }
+    printf("[net] WiFi connected\n");
+
+    g_netState = NET_STATE_MQTT;
+    if (Net_ConnectMqtt() != 0)
+    {
+        printf("[net] MQTT failed to connect\n");
+        Net_Fail(NET_STATE_MQTT_FAILED);
+    }
+    Net_SessionUp();
+
+    // 本线程即接收线程。发送线程发布失败时，对端关闭的 socket 会很快变为可读；
+    // 即使没有，最迟在下一次空闲超时醒来时也会发现队列已断开
+    while (1)
+    {
+        Net_SubscribePending();
+        if (MqttRx_RunOnce() != 0 || !MqttPubq_IsOnline())
+            Net_Reconnect();
+    }
+}
+
+static int Net_StrDiff(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL)
+        return a != b;
+    return strcmp(a, b) != 0;
+}
+
+/* 后启动的模块带来的配置与生效的不同：逐项打出来，不让它被悄悄忽略 */
+static void Net_CheckConfig(const NetServiceConfig_t *cfg)
+{
+    const NetServiceConfig_t *cur = &g_netCfg;
+    if (Net_StrDiff(cfg->ssid, cur->ssid) || Net_StrDiff(cfg->password, cur->password))
+        printf("[net] config conflict: WiFi %s ignored, keeping %s\n", cfg->ssid, cur->ssid);
+    if (Net_StrDiff(cfg->serverIp, cur->serverIp) || cfg->serverPort != cur->serverPort)
+        printf("[net] config conflict: server %s:%d ignored, keeping %s:%d\n", cfg->serverIp, cfg->serverPort,
+               cur->serverIp, cur->serverPort);
+    if (Net_StrDiff(cfg->clientId, cur->clientId))
+        printf("[net] config conflict: client id %s ignored, keeping %s\n", cfg->clientId, cur->clientId);
+    if (Net_StrDiff(cfg->userName, cur->userName) || Net_StrDiff(cfg->userPassword, cur->userPassword))
+        printf("[net] config conflict: credentials for %s ignored, keeping %s\n", cfg->userName, cur->userName);
+    if (cfg->pubPolicy != cur->pubPolicy)
+        printf("[net] config conflict: publish policy %d ignored, keeping %d\n", cfg->pubPolicy, cur->pubPolicy);
+}
+
+int NetService_Start(const NetServiceConfig_t *cfg)
+{
+    // 只在初始化阶段 (SYS_RUN 入口依次执行) 调用，检查和置位之间不会有别的调用者
+    if (g_netStarted)
+    {
+        Net_CheckConfig(cfg);
+        return 0;
+    }
+
+    // 先把 WaitUp/Publish 要用的对象都建好，再对外宣布已启动
+    memcpy(&g_netCfg, cfg, sizeof(g_netCfg));
+    g_netEvent = osEventFlagsNew(NULL);
+    if (g_netEvent == NULL || MqttLock_Init() != 0 || MqttPubq_Start(g_netCfg.pubPolicy) != 0)
+        return -1;
+
+    osThreadAttr_t attr = {0};
+    attr.name = "NetService";
+    attr.stack_size = NET_SERVICE_STACK;
+    attr.priority = osPriorityNormal;
+    if (osThreadNew(NetService_Task, NULL, &attr) == NULL)
+        return -1;
+    g_netStarted = 1;
+    return 0;
+}
+
+int NetService_Subscribe(const char *topic, NetTopicHandler_t handler)
+{
+    if (strlen(topic) >= NET_TOPIC_MAX)
+        return -1;
+    uint32_t hash = Net_Hash(topic);
+    int i = Net_Probe(topic, hash, NULL);
+    if (i < 0)
+        return -1;
+    NetRoute_t *r = &g_netRoutes[i];
+    r->handler = handler;
+    if (!r->used)
+    {
+        r->hash = hash;
+        strcpy(r->topic, topic);
+        r->used = 1;
+    }
+    return 0;
+}
+
+int NetService_Publish(const char *topic, const uint8_t *payload, size_t len, uint8_t flags)
+{
+    if (g_netState != NET_STATE_UP)
+        return -1;
+    return MqttPubq_Publish(topic, payload, len, flags);
+}
+
+NetState_t NetService_GetState(void)
+{
+    return g_netState;
+}
+
+int NetService_WaitUp(uint32_t timeout)
+{
+    if (g_netEvent == NULL)
+        return -1;
+    uint32_t flags = osEventFlagsWait(g_netEvent, NET_EVT_UP | NET_EVT_FAILED, osFlagsWaitAny | osFlagsNoClear,
+                                      timeout);
+    return (flags & osFlagsError) == 0 && (flags & NET_EVT_UP) ? 0 : -1;
+}
+
+void NetService_GetStats(NetServiceStats_t *out)
+{
+    memcpy(out, &g_netStats, sizeof(*out));
+}
@@ -0,0 +1,91 @@
+/*
+ * 网络服务 (雷达与各实验共用)
+ *
+ * 一个 NetService 线程负责整个网络会话：连 WiFi、等 IP、连 MQTT 服务器、初始化客户端，
+ * 然后订阅各模块注册过的主题，之后就留在 mqtt_rx 的接收循环里；发布统一走 mqtt_pubq。
+ * 所有 MQTTClient_* 调用都在 mqtt_lock 内，接收/保活与发布不会同时写 socket。
+ * 读包失败或发布失败时服务线程断开重连 (WiFi 已掉线则先重新连接热点) 并重新订阅，期间 NetService_Publish 返回 -1，
+ * 已入队的消息保留到重连后发出。
+ * bsp_mqtt 只有一个全局回调 p_MQTTClient_sub_callback，这里把它接到按主题哈希的路由表上，
+ * 每个模块注册自己的 主题 → 处理函数，同一镜像里可以同时跑多个模块。
+ *
+ * 主题按全文精确匹配 (不支持 +/# 通配)。会话建立后才注册的主题，
+ * 在服务线程下一次醒来 (收到消息或空闲超时) 时补订阅。
+ * NetService_Start 必须在应用入口 (SYS_RUN) 里调用，不要放进自己创建的线程：
+ * 入口函数在系统初始化阶段依次执行，启动检查不用加锁，WaitUp 也总能看到已创建的事件。
+ * 多个模块都调用时第一次调用的配置生效，之后的调用返回 0，与生效配置不同的项会逐项打印出来。
+ *
+ *   NetService_Subscribe("hi3861/led/brightness", &OnBrightness);
+ *   NetService_Start(&cfg);
+ *   if (NetService_WaitUp(osWaitForever) == 0)
+ *       NetService_Publish(topic, payload, len, 0);
+ */
+#ifndef NET_SERVICE_H
+#define NET_SERVICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mqtt_pubq.h"
+
+#ifndef NET_ROUTE_SLOTS
+#define NET_ROUTE_SLOTS 16 // 路由表槽数 (2 的幂)，开放寻址，装载不超过一半时探测很短
+#endif
+#define NET_TOPIC_MAX 64
+#ifndef NET_SERVICE_STACK
+#define NET_SERVICE_STACK 4096 // WiFi 连接 + MQTT 握手 + 收包解码
+#endif
+#define NET_WIFI_WAIT_S 20 // 等待获取 IP 的时间
+#define NET_MQTT_RETRY 5   // 连接服务器的重试次数
+#define NET_MQTT_RETRY_S 2 // 重试间隔 (首次连接与断线重连共用)
+
+typedef int8_t (*NetTopicHandler_t)(unsigned char *topic, unsigned char *payload);
+
+typedef struct
+{
+    const char *ssid;
+    const char *password;
+    const char *serverIp; // Hi3861 不支持域名，必须用 IP
+    int serverPort;
+    const char *clientId;
+    const char *userName;
+    const char *userPassword;
+    MqttPubqPolicy_t pubPolicy;
+} NetServiceConfig_t;
+
+typedef enum
+{
+    NET_STATE_IDLE,
+    NET_STATE_WIFI,        // 正在连 WiFi / 等 IP
+    NET_STATE_MQTT,        // 正在连 MQTT 服务器
+    NET_STATE_UP,          // 会话已建立，收发正常
+    NET_STATE_WIFI_FAILED, // 超时没拿到 IP
+    NET_STATE_MQTT_FAILED, // 服务器连不上或 CONNECT 被拒
+} NetState_t;
+
+typedef struct
+{
+    uint32_t routed;      // 交给处理函数的消息
+    uint32_t unrouted;    // 没有注册处理函数的主题
+    uint32_t probeMax;    // 查表最长探测次数
+    uint32_t reconnects;  // 会话断开后重连的次数
+    uint32_t wifiRejoins; // 重连时发现 WiFi 已断开、重新连接热点的次数
+} NetServiceStats_t;
+
+/* 只能在应用入口 (初始化阶段) 调用，成功返回 0 */
+int NetService_Start(const NetServiceConfig_t *cfg);
+
+/* 注册主题的处理函数 (同一主题再次注册则替换)，表满返回 -1 */
+int NetService_Subscribe(const char *topic, NetTopicHandler_t handler);
+
+/* 会话未建立时返回 -1，其余同 MqttPubq_Publish */
+int NetService_Publish(const char *topic, const uint8_t *payload, size_t len, uint8_t flags);
+
+NetState_t NetService_GetState(void);
+
+/* 等待会话建立，成功返回 0；连接失败或超时返回 -1 */
+int NetService_WaitUp(uint32_t timeout);
+
+void NetService_GetStats(NetServiceStats_t *out);
+
+#endif
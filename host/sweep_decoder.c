@@ -0,0 +1,120 @@
+/*
+ * 扫描帧二进制上报的主机解码库 (格式见 ../radar_sweep.h)
+ */
+#include <string.h>
+
+#include "../radar_sweep.h"
+#include "sweep_decoder.h"
+
+static uint16_t Sweep_GetU16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t Sweep_GetU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void SweepDecoder_Init(SweepDecoder_t *dec)
+{
+    memset(dec, 0, sizeof(*dec));
+}
+
+SweepResult_t SweepDecoder_Feed(SweepDecoder_t *dec, const uint8_t *buf, size_t len, SweepDecoded_t *out)
+{
+    if (len < SWEEP_HDR_SIZE || buf[0] != SWEEP_MAGIC || buf[1] != SWEEP_VERSION)
+        return SWEEP_ERR_FORMAT;
+
+    memset(out, 0, sizeof(*out));
+    out->key = (buf[2] & SWEEP_FLAG_KEY) != 0;
+    out->bins = buf[3];
+    out->seq = Sweep_GetU32(buf + 4);
+    out->baseSeq = Sweep_GetU32(buf + 8);
+    out->endMs = Sweep_GetU32(buf + 12);
+    out->spanMs = Sweep_GetU16(buf + 16);
+    out->a0 = buf[18];
+    out->da = buf[19];
+    out->dir = (int8_t)buf[20];
+    out->state = buf[21];
+    out->fgCount = buf[22];
+    out->objectCount = buf[23];
+    if (out->objectCount > SWEEP_MAX_OBJECTS)
+        return SWEEP_ERR_FORMAT;
+
+    // 差分基准：关键帧为全零，否则必须是上一次解码的那一帧
+    const uint16_t *base = NULL;
+    if (!out->key)
+    {
+        if (!dec->haveBase || dec->baseSeq != out->baseSeq || dec->bins != out->bins)
+            return SWEEP_ERR_BASE;
+        base = dec->baseMm;
+    }
+
+    size_t pos = SWEEP_HDR_SIZE;
+    size_t maskLen = ((size_t)out->bins + 7) / 8;
+    if (pos + maskLen > len)
+        return SWEEP_ERR_FORMAT;
+    memcpy(out->fgMask, buf + pos, maskLen);
+    pos += maskLen;
+
+    // 距离块
+    int i = 0;
+    while (i < out->bins)
+    {
+        if (pos >= len)
+            return SWEEP_ERR_FORMAT;
+        uint8_t op = buf[pos++];
+        int run = (op & ~SWEEP_OP_MASK) + 1;
+        if (i + run > out->bins)
+            return SWEEP_ERR_FORMAT;
+        for (int k = 0; k < run; k++, i++)
+        {
+            uint16_t b = base ? base[i] : 0;
+            switch (op & SWEEP_OP_MASK)
+            {
+            case SWEEP_OP_SAME:
+                out->rangeMm[i] = b;
+                break;
+            case SWEEP_OP_DELTA8:
+                if (pos + 1 > len)
+                    return SWEEP_ERR_FORMAT;
+                out->rangeMm[i] = (uint16_t)(b + (int8_t)buf[pos++]);
+                break;
+            case SWEEP_OP_ABS16:
+                if (pos + 2 > len)
+                    return SWEEP_ERR_FORMAT;
+                out->rangeMm[i] = Sweep_GetU16(buf + pos);
+                pos += 2;
+                break;
+            default:
+                return SWEEP_ERR_FORMAT;
+            }
+        }
+    }
+
+    // 测距时刻块
+    if (pos + out->bins > len)
+        return SWEEP_ERR_FORMAT;
+    for (i = 0; i < out->bins; i++, pos++)
+        out->ageMs[i] = buf[pos] == SWEEP_AGE_NONE ? -1 : (int32_t)buf[pos] * SWEEP_AGE_UNIT_MS;
+
+    // 目标表
+    if (pos + (size_t)out->objectCount * SWEEP_OBJ_SIZE != len)
+        return SWEEP_ERR_FORMAT;
+    for (i = 0; i < out->objectCount; i++, pos += SWEEP_OBJ_SIZE)
+    {
+        SweepObject_t *o = &out->objects[i];
+        o->id = buf[pos];
+        o->bearing = buf[pos + 1];
+        o->rangeMm = Sweep_GetU16(buf + pos + 2);
+        o->velMmS = (int16_t)Sweep_GetU16(buf + pos + 4);
+        o->ttcMs = Sweep_GetU16(buf + pos + 6);
+    }
+
+    dec->haveBase = 1;
+    dec->baseSeq = out->seq;
+    dec->bins = out->bins;
+    memcpy(dec->baseMm, out->rangeMm, sizeof(dec->baseMm));
+    return SWEEP_OK;
+}
@@ -0,0 +1,70 @@
+/*
+ * 扫描帧二进制上报的主机解码库 (格式见 ../radar_sweep.h)
+ *
+ * 解码器保存上一次成功解码的帧作为差分基准。差分帧的 baseSeq 与之不符时
+ * (漏收了消息或刚开始订阅) 返回 SWEEP_ERR_BASE，等下一个关键帧即可恢复。
+ *
+ *   SweepDecoder_t dec;
+ *   SweepDecoder_Init(&dec);
+ *   // 每收到一条 MQTT_TOPIC_DATA 消息：
+ *   SweepDecoded_t sweep;
+ *   if (SweepDecoder_Feed(&dec, payload, len, &sweep) == SWEEP_OK)
+ *       ... sweep.rangeMm[i] 即 sweep.a0 + i * sweep.da 度的距离 ...
+ */
+#ifndef SWEEP_DECODER_H
+#define SWEEP_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SWEEP_MAX_BINS 255
+#define SWEEP_MAX_OBJECTS 32
+
+typedef enum
+{
+    SWEEP_OK = 0,
+    SWEEP_ERR_FORMAT = -1,  // 不是扫描帧、版本不支持或长度不符
+    SWEEP_ERR_BASE = -2,    // 差分基准不是上一次解码的帧
+} SweepResult_t;
+
+typedef struct
+{
+    uint8_t id;
+    uint8_t bearing;
+    uint16_t rangeMm;
+    int16_t velMmS;
+    uint16_t ttcMs; // SWEEP_TTC_NONE 表示不在接近中
+} SweepObject_t;
+
+typedef struct
+{
+    uint8_t key; // 是否关键帧
+    uint32_t seq;
+    uint32_t baseSeq;
+    uint32_t endMs;
+    uint16_t spanMs;
+    uint8_t a0;
+    uint8_t da;
+    int8_t dir;
+    uint8_t state;
+    uint8_t fgCount;
+    uint8_t bins;
+    uint8_t objectCount;
+    uint16_t rangeMm[SWEEP_MAX_BINS];
+    int32_t ageMs[SWEEP_MAX_BINS]; // 距 endMs 的时间，-1 表示从未测到 (精度 SWEEP_AGE_UNIT_MS，超过上限时取上限)
+    uint8_t fgMask[(SWEEP_MAX_BINS + 7) / 8];
+    SweepObject_t objects[SWEEP_MAX_OBJECTS];
+} SweepDecoded_t;
+
+typedef struct
+{
+    uint8_t haveBase;
+    uint32_t baseSeq;
+    uint8_t bins;
+    uint16_t baseMm[SWEEP_MAX_BINS];
+} SweepDecoder_t;
+
+void SweepDecoder_Init(SweepDecoder_t *dec);
+SweepResult_t SweepDecoder_Feed(SweepDecoder_t *dec, const uint8_t *buf, size_t len, SweepDecoded_t *out);
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * 扫描帧二进制上报格式 (MQTT_TOPIC_DATA)
+ * 固件编码端 (ultrasonic_radar.c) 与主机解码库 (host/sweep_decoder.c) 共用，改动格式须递增 SWEEP_VERSION。
+ *
+ * 一条消息 = 固定头 + 前景位图 + 距离块 + 测距时刻块 + 目标表，多字节字段一律小端。
+ *
+ * 固定头 (SWEEP_HDR_SIZE 字节)：
+ *   0  magic    SWEEP_MAGIC
+ *   1  version  SWEEP_VERSION
+ *   2  flags    SWEEP_FLAG_KEY：距离相对全零编码 (关键帧)；否则相对 baseSeq 那一帧的距离
+ *   3  bins     角度数，第 i 个角度为 a0 + i * da 度
+ *   4  seq      u32 帧序号
+ *   8  baseSeq  u32 差分基准帧序号 (关键帧为 0)
+ *   12 endMs    u32 帧发布时刻
+ *   16 spanMs   u16 本帧扫描用时
+ *   18 a0       u8
+ *   19 da       u8
+ *   20 dir      i8 扫描方向 (1 递增, -1 递减)
+ *   21 state    u8 系统状态
+ *   22 fgCount  u8 前景角度数
+ *   23 objects  u8 目标数
+ * 前景位图：(bins + 7) / 8 字节，第 i 位对应第 i 个角度
+ * 距离块：一串操作，每个操作覆盖 (低 6 位 + 1) 个角度，距离 (mm) = 基准 + 差分
+ *   00nnnnnn  与基准相同
+ *   01nnnnnn  后跟 n+1 个 int8 差分
+ *   10nnnnnn  后跟 n+1 个 u16 绝对值
+ * 测距时刻块：bins 字节，距 endMs 的时间，单位 SWEEP_AGE_UNIT_MS；
+ *   SWEEP_AGE_MAX 表示不短于该值，SWEEP_AGE_NONE 表示从未测到
+ * 目标表：每个目标 SWEEP_OBJ_SIZE 字节：id u8, bearing u8, rangeMm u16, velMmS i16, ttcMs u16 (0xFFFF 不在接近中)
+ */
+#ifndef RADAR_SWEEP_H
+#define RADAR_SWEEP_H
+
+#define SWEEP_MAGIC 0x52 // 'R'
+#define SWEEP_VERSION 1
+#define SWEEP_FLAG_KEY 0x01
+
+#define SWEEP_HDR_SIZE 24
+#define SWEEP_OBJ_SIZE 8
+// 一条消息的最大长度：距离块最坏每个角度 1 字节操作 + 2 字节绝对值
+#define SWEEP_MAX_SIZE(bins, objs) (SWEEP_HDR_SIZE + ((bins) + 7) / 8 + (bins) * 4 + (objs) * SWEEP_OBJ_SIZE)
+
+#define SWEEP_OP_SAME 0x00
+#define SWEEP_OP_DELTA8 0x40
+#define SWEEP_OP_ABS16 0x80
+#define SWEEP_OP_MASK 0xC0
+#define SWEEP_OP_RUN_MAX 64
+
+#define SWEEP_AGE_UNIT_MS 20
+#define SWEEP_AGE_MAX 254
+#define SWEEP_AGE_NONE 255
+
+#define SWEEP_TTC_NONE 0xFFFF
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * 主机仿真替身：bsp_adc (实验41：光敏传感器接 ADC5)
+ */
+#ifndef BSP_ADC_H
+#define BSP_ADC_H
+
+#include <stdint.h>
+
+void adc5_init(void);
+uint16_t get_adc5_value(void);
+
+#endif
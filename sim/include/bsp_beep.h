@@ -0,0 +1,17 @@
+/*
+ * 主机仿真替身：bsp_beep
+ */
+#ifndef BSP_BEEP_H
+#define BSP_BEEP_H
+
+#include "hi_gpio.h"
+#include "hi_io.h"
+
+#define BEEP_PIN HI_IO_NAME_GPIO_5
+#define BEEP_GPIO_FUN 0
+
+#define BEEP(a) hi_gpio_set_ouput_val(BEEP_PIN, a)
+
+void beep_init(void);
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * 主机仿真替身：bsp_key (按键事件由场景脚本注入)
+ */
+#ifndef BSP_KEY_H
+#define BSP_KEY_H
+
+#include <stdint.h>
+
+#define KEY1_PRESS 1
+#define KEY2_PRESS 2
+#define KEY3_PRESS 3
+
+void key_init(void);
+uint8_t key_scan(uint8_t mode);
+
+#endif
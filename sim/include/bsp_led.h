@@ -0,0 +1,17 @@
+/*
+ * 主机仿真替身：bsp_led (LED 接 GPIO2，高电平点亮)
+ */
+#ifndef BSP_LED_H
+#define BSP_LED_H
+
+#include "hi_gpio.h"
+#include "hi_io.h"
+
+#define LED_PIN HI_IO_NAME_GPIO_2
+#define LED_GPIO_FUN HI_IO_FUNC_GPIO_2_GPIO
+
+#define LED(a) hi_gpio_set_ouput_val(LED_PIN, a)
+
+void led_init(void);
+
+#endif
@@ -0,0 +1,22 @@
+/*
+ * 主机仿真替身：bsp_mqtt (基于 paho MQTTPacket 的同步客户端)
+ * 服务器由仿真器内置的 broker 替身扮演，订阅消息来自场景脚本
+ */
+#ifndef BSP_MQTT_H
+#define BSP_MQTT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern int8_t (*p_MQTTClient_sub_callback)(unsigned char *topic, unsigned char *payload);
+
+int MQTTClient_connectServer(const char *ip_addr, int ip_port);
+int MQTTClient_init(char *clientID, char *userName, char *password);
+int MQTTClient_subscribe(char *subTopic);
+int MQTTClient_pub(char *pub_Topic, unsigned char *payloadData, size_t payloadLen);
+int MQTTClient_sub(void);
+int MQTTClient_getSocket(void); // 事件驱动接收 (common/mqtt_rx.c) 需要 bsp_mqtt 导出内部 socket
+void MQTTClient_unsubscribe(char *topic);
+void MQTTClient_disconnect(void);
+
+#endif
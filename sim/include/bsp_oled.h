@@ -0,0 +1,26 @@
+/*
+ * 主机仿真替身：bsp_oled (SSD1306 128x64, I2C)
+ */
+#ifndef BSP_OLED_H
+#define BSP_OLED_H
+
+#include <stdint.h>
+
+#define OLED_CMD 0
+#define OLED_DATA 1
+
+void oled_init(void);
+void oled_wr_byte(uint8_t dat, uint8_t cmd);
+void oled_display_on(void);
+void oled_display_off(void);
+void oled_refresh_gram(void);
+void oled_clear(void);
+void oled_drawpoint(uint8_t x, uint8_t y, uint8_t t);
+void oled_draw_bigpoint(uint8_t x, uint8_t y, uint8_t t);
+void oled_drawline(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t t);
+void oled_fill(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t dot);
+void oled_showchar(uint8_t x, uint8_t y, uint8_t chr, uint8_t size, uint8_t mode);
+void oled_shownum(uint8_t x, uint8_t y, uint32_t num, uint8_t len, uint8_t size);
+void oled_showstring(uint8_t x, uint8_t y, const uint8_t *p, uint8_t size);
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * 主机仿真替身：bsp_pwm (实验16：LED 调光，占空比 0~3000)
+ * 只记录占空比变化，合并镜像 (make combo) 中的实验3用它确认亮度指令已生效
+ */
+#ifndef BSP_PWM_H
+#define BSP_PWM_H
+
+#include <stdint.h>
+
+void pwm_init(void);
+void pwm_set_duty(uint16_t duty);
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * 主机仿真替身：bsp_sg90 (舵机，50Hz PWM)
+ */
+#ifndef BSP_SG90_H
+#define BSP_SG90_H
+
+#include <stdint.h>
+
+void sg90_init(void);
+void set_sg90_angle(uint16_t angle);
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * 主机仿真替身：bsp_sr04 (HC-SR04 超声波测距)
+ * sr04_read_distance 与原驱动一致：忙等回波，返回 cm
+ */
+#ifndef BSP_SR04_H
+#define BSP_SR04_H
+
+#include "hi_gpio.h"
+#include "hi_io.h"
+
+#define SR04_TRIG_PIN HI_IO_NAME_GPIO_8
+#define SR04_TRIG_GPIO_FUN HI_IO_FUNC_GPIO_8_GPIO
+#define SR04_ECHO_PIN HI_IO_NAME_GPIO_12
+#define SR04_ECHO_GPIO_FUN HI_IO_FUNC_GPIO_12_GPIO
+
+void sr04_init(void);
+float sr04_read_distance(void);
+
+#endif
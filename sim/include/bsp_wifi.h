@@ -0,0 +1,25 @@
+/*
+ * 主机仿真替身：bsp_wifi (STA 连接热点)
+ */
+#ifndef BSP_WIFI_H
+#define BSP_WIFI_H
+
+typedef enum
+{
+    WIFI_SUCCESS = 0,
+    ERROR_WIFI_INVALID_ARGS = -1,
+    ERROR_WIFI_CHIP_INVALID = -2,
+    ERROR_WIFI_IFACE_INVALID = -3,
+    ERROR_WIFI_RTT_CONTROLLER_INVALID = -4,
+    ERROR_WIFI_NOT_SUPPORTED = -5,
+    ERROR_WIFI_NOT_AVAILABLE = -6,
+    ERROR_WIFI_NOT_STARTED = -7,
+    ERROR_WIFI_BUSY = -8,
+    ERROR_WIFI_INVALID_PASSWORD = -9,
+    ERROR_WIFI_UNKNOWN = -128
+} WifiErrorCode;
+
+WifiErrorCode WiFi_connectHotspots(const char *ssid, const char *psk);
+char *WiFi_GetLocalIP(void);
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ * 主机仿真替身：CMSIS-RTOS2 接口子集
+ * 由 sim_os.c 在虚拟时钟上实现，语义对齐 LiteOS-M (单核、抢占式、同优先级时间片轮转)
+ */
+#ifndef CMSIS_OS2_H_
+#define CMSIS_OS2_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define osWaitForever 0xFFFFFFFFU
+
+#define osFlagsWaitAny 0x00000000U
+#define osFlagsWaitAll 0x00000001U
+#define osFlagsNoClear 0x00000002U
+
+#define osFlagsError 0x80000000U
+#define osFlagsErrorUnknown 0xFFFFFFFFU
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+#define osFlagsErrorResource 0xFFFFFFFDU
+#define osFlagsErrorParameter 0xFFFFFFFCU
+
+#define osMutexRecursive 0x00000001U
+#define osMutexPrioInherit 0x00000002U
+
+typedef enum
+{
+    osOK = 0,
+    osError = -1,
+    osErrorTimeout = -2,
+    osErrorResource = -3,
+    osErrorParameter = -4,
+    osErrorNoMemory = -5,
+    osErrorISR = -6,
+    osStatusReserved = 0x7FFFFFFF
+} osStatus_t;
+
+typedef enum
+{
+    osPriorityNone = 0,
+    osPriorityIdle = 1,
+    osPriorityLow = 8,
+    osPriorityBelowNormal = 16,
+    osPriorityNormal = 24,
+    osPriorityNormal1 = 24 + 1,
+    osPriorityNormal2 = 24 + 2,
+    osPriorityNormal3 = 24 + 3,
+    osPriorityNormal4 = 24 + 4,
+    osPriorityNormal5 = 24 + 5,
+    osPriorityNormal6 = 24 + 6,
+    osPriorityNormal7 = 24 + 7,
+    osPriorityAboveNormal = 32,
+    osPriorityHigh = 40,
+    osPriorityRealtime = 48,
+    osPriorityISR = 56,
+    osPriorityError = -1,
+    osPriorityReserved = 0x7FFFFFFF
+} osPriority_t;
+
+typedef enum
+{
+    osTimerOnce = 0,
+    osTimerPeriodic = 1
+} osTimerType_t;
+
+typedef void (*osThreadFunc_t)(void *argument);
+typedef void (*osTimerFunc_t)(void *argument);
+
+typedef void *osThreadId_t;
+typedef void *osTimerId_t;
+typedef void *osEventFlagsId_t;
+typedef void *osMutexId_t;
+typedef void *osSemaphoreId_t;
+typedef void *osMessageQueueId_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+    void *stack_mem;
+    uint32_t stack_size;
+    osPriority_t priority;
+    uint32_t tz_module;
+    uint32_t reserved;
+} osThreadAttr_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+} osTimerAttr_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+} osEventFlagsAttr_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+} osMutexAttr_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+} osSemaphoreAttr_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+    void *mq_mem;
+    uint32_t mq_size;
+} osMessageQueueAttr_t;
+
+/* 内核 */
+uint32_t osKernelGetTickCount(void);
+uint32_t osKernelGetTickFreq(void);
+uint32_t osKernelGetSysTimerCount(void);
+uint32_t osKernelGetSysTimerFreq(void);
+
+/* 线程 */
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr);
+osThreadId_t osThreadGetId(void);
+const char *osThreadGetName(osThreadId_t thread_id);
+osStatus_t osThreadYield(void);
+osStatus_t osDelay(uint32_t ticks);
+osStatus_t osDelayUntil(uint32_t ticks);
+
+/* 软件定时器 */
+osTimerId_t osTimerNew(osTimerFunc_t func, osTimerType_t type, void *argument, const osTimerAttr_t *attr);
+osStatus_t osTimerStart(osTimerId_t timer_id, uint32_t ticks);
+osStatus_t osTimerStop(osTimerId_t timer_id);
+
+/* 事件标志 */
+osEventFlagsId_t osEventFlagsNew(const osEventFlagsAttr_t *attr);
+uint32_t osEventFlagsSet(osEventFlagsId_t ef_id, uint32_t flags);
+uint32_t osEventFlagsClear(osEventFlagsId_t ef_id, uint32_t flags);
+uint32_t osEventFlagsGet(osEventFlagsId_t ef_id);
+uint32_t osEventFlagsWait(osEventFlagsId_t ef_id, uint32_t flags, uint32_t options, uint32_t timeout);
+
+/* 互斥锁 */
+osMutexId_t osMutexNew(const osMutexAttr_t *attr);
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+osStatus_t osMutexRelease(osMutexId_t mutex_id);
+
+/* 信号量 */
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr);
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout);
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id);
+
+/* 消息队列 */
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr);
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout);
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout);
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id);
+
+#endif
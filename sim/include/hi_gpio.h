@@ -0,0 +1,66 @@
+/*
+ * 主机仿真替身：Hi3861 GPIO
+ */
+#ifndef HI_GPIO_H
+#define HI_GPIO_H
+
+#include "hi_types_base.h"
+
+typedef enum
+{
+    HI_GPIO_IDX_0,
+    HI_GPIO_IDX_1,
+    HI_GPIO_IDX_2,
+    HI_GPIO_IDX_3,
+    HI_GPIO_IDX_4,
+    HI_GPIO_IDX_5,
+    HI_GPIO_IDX_6,
+    HI_GPIO_IDX_7,
+    HI_GPIO_IDX_8,
+    HI_GPIO_IDX_9,
+    HI_GPIO_IDX_10,
+    HI_GPIO_IDX_11,
+    HI_GPIO_IDX_12,
+    HI_GPIO_IDX_13,
+    HI_GPIO_IDX_14,
+    HI_GPIO_IDX_MAX,
+} hi_gpio_idx;
+
+typedef enum
+{
+    HI_GPIO_VALUE0 = 0,
+    HI_GPIO_VALUE1
+} hi_gpio_value;
+
+typedef enum
+{
+    HI_GPIO_DIR_IN = 0,
+    HI_GPIO_DIR_OUT
+} hi_gpio_dir;
+
+typedef enum
+{
+    HI_INT_TYPE_LEVEL = 0,
+    HI_INT_TYPE_EDGE = 1
+} hi_gpio_int_type;
+
+typedef enum
+{
+    HI_GPIO_EDGE_FALL_LEVEL_LOW = 0,
+    HI_GPIO_EDGE_RISE_LEVEL_HIGH = 1
+} hi_gpio_int_polarity;
+
+typedef hi_void (*gpio_isr_callback)(hi_void *arg);
+
+hi_u32 hi_gpio_init(hi_void);
+hi_u32 hi_gpio_set_dir(hi_gpio_idx id, hi_gpio_dir dir);
+hi_u32 hi_gpio_set_ouput_val(hi_gpio_idx id, hi_gpio_value val);
+hi_u32 hi_gpio_get_input_val(hi_gpio_idx id, hi_gpio_value *val);
+hi_u32 hi_gpio_register_isr_function(hi_gpio_idx id, hi_gpio_int_type int_type,
+                                     hi_gpio_int_polarity int_polarity,
+                                     gpio_isr_callback func, hi_char *arg);
+hi_u32 hi_gpio_unregister_isr_function(hi_gpio_idx id);
+hi_u32 hi_gpio_set_isr_mode(hi_gpio_idx id, hi_gpio_int_type int_type, hi_gpio_int_polarity int_polarity);
+hi_u32 hi_gpio_set_isr_mask(hi_gpio_idx id, hi_bool is_mask);
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * 主机仿真替身：Hi3861 高精度定时器
+ * 回调在"中断上下文"执行，超时单位为微秒
+ */
+#ifndef HI_HRTIMER_H
+#define HI_HRTIMER_H
+
+#include "hi_types_base.h"
+
+typedef hi_void (*hi_hrtimer_callback_f)(hi_u32 data);
+
+hi_u32 hi_hrtimer_create(hi_u32 *timer_handle);
+hi_u32 hi_hrtimer_delete(hi_u32 timer_handle);
+hi_u32 hi_hrtimer_start(hi_u32 timer_handle, hi_u32 expire, hi_hrtimer_callback_f hrtimer_func, hi_u32 data);
+hi_u32 hi_hrtimer_stop(hi_u32 timer_handle);
+
+#endif
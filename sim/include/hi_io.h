@@ -0,0 +1,49 @@
+/*
+ * 主机仿真替身：Hi3861 IO 复用
+ */
+#ifndef HI_IO_H
+#define HI_IO_H
+
+#include "hi_types_base.h"
+
+typedef enum
+{
+    HI_IO_NAME_GPIO_0,
+    HI_IO_NAME_GPIO_1,
+    HI_IO_NAME_GPIO_2,
+    HI_IO_NAME_GPIO_3,
+    HI_IO_NAME_GPIO_4,
+    HI_IO_NAME_GPIO_5,
+    HI_IO_NAME_GPIO_6,
+    HI_IO_NAME_GPIO_7,
+    HI_IO_NAME_GPIO_8,
+    HI_IO_NAME_GPIO_9,
+    HI_IO_NAME_GPIO_10,
+    HI_IO_NAME_GPIO_11,
+    HI_IO_NAME_GPIO_12,
+    HI_IO_NAME_GPIO_13,
+    HI_IO_NAME_GPIO_14,
+    HI_IO_NAME_MAX,
+} hi_io_name;
+
+typedef enum
+{
+    HI_IO_PULL_NONE,
+    HI_IO_PULL_UP,
+    HI_IO_PULL_DOWN,
+    HI_IO_PULL_MAX,
+} hi_io_pull;
+
+/* 仿真只区分 GPIO 与外设复用，功能号取值与芯片手册一致即可 */
+#define HI_IO_FUNC_GPIO_2_GPIO 0
+#define HI_IO_FUNC_GPIO_2_PWM2_OUT 5
+#define HI_IO_FUNC_GPIO_7_GPIO 0
+#define HI_IO_FUNC_GPIO_7_PWM0_OUT 5
+#define HI_IO_FUNC_GPIO_8_GPIO 0
+#define HI_IO_FUNC_GPIO_11_GPIO 0
+#define HI_IO_FUNC_GPIO_12_GPIO 0
+
+hi_u32 hi_io_set_func(hi_io_name id, hi_u8 val);
+hi_u32 hi_io_set_pull(hi_io_name id, hi_io_pull val);
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * 主机仿真替身：Hi3861 PWM
+ */
+#ifndef HI_PWM_H
+#define HI_PWM_H
+
+#include "hi_types_base.h"
+
+typedef enum
+{
+    HI_PWM_PORT_PWM0 = 0,
+    HI_PWM_PORT_PWM1 = 1,
+    HI_PWM_PORT_PWM2 = 2,
+    HI_PWM_PORT_PWM3 = 3,
+    HI_PWM_PORT_PWM4 = 4,
+    HI_PWM_PORT_PWM5 = 5,
+    HI_PWM_PORT_MAX
+} hi_pwm_port;
+
+typedef enum
+{
+    PWM_CLK_160M,
+    PWM_CLK_XTAL,
+    PWM_CLK_MAX
+} hi_pwm_clk_source;
+
+hi_u32 hi_pwm_init(hi_pwm_port port);
+hi_u32 hi_pwm_deinit(hi_pwm_port port);
+hi_u32 hi_pwm_set_clock(hi_pwm_clk_source clk_type);
+hi_u32 hi_pwm_start(hi_pwm_port port, hi_u16 duty, hi_u16 freq);
+hi_u32 hi_pwm_stop(hi_pwm_port port);
+
+#endif
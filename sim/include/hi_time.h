@@ -0,0 +1,17 @@
+/*
+ * 主机仿真替身：Hi3861 时间接口
+ * hi_udelay 为忙等，会占用 CPU 的虚拟时间
+ */
+#ifndef HI_TIME_H
+#define HI_TIME_H
+
+#include "hi_types_base.h"
+
+hi_void hi_udelay(hi_u32 us);
+hi_u32 hi_get_tick(hi_void);
+hi_u64 hi_get_tick64(hi_void);
+hi_u32 hi_get_milli_seconds(hi_void);
+hi_u32 hi_get_seconds(hi_void);
+hi_u32 hi_get_us(hi_void);
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * 主机仿真替身：Hi3861 SDK 基础类型
+ */
+#ifndef HI_TYPES_BASE_H
+#define HI_TYPES_BASE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef void hi_void;
+typedef char hi_char;
+typedef uint8_t hi_u8;
+typedef uint16_t hi_u16;
+typedef uint32_t hi_u32;
+typedef uint64_t hi_u64;
+typedef int8_t hi_s8;
+typedef int16_t hi_s16;
+typedef int32_t hi_s32;
+typedef int hi_bool;
+
+#define HI_TRUE 1
+#define HI_FALSE 0
+#define HI_ERR_SUCCESS 0
+#define HI_ERR_FAILURE ((hi_u32)(-1))
+
+#endif
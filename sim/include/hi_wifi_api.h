@@ -0,0 +1,9 @@
+/*
+ * 主机仿真替身：Hi3861 WiFi API (仿真中不直接使用，由 bsp_wifi 代理)
+ */
+#ifndef HI_WIFI_API_H
+#define HI_WIFI_API_H
+
+#include "hi_types_base.h"
+
+#endif
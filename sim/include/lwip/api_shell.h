@@ -0,0 +1,7 @@
+/*
+ * 主机仿真替身：lwIP shell 命令
+ */
+#ifndef LWIP_API_SHELL_H
+#define LWIP_API_SHELL_H
+
+#endif
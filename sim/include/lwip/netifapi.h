@@ -0,0 +1,7 @@
+/*
+ * 主机仿真替身：lwIP netifapi
+ */
+#ifndef LWIP_NETIFAPI_H
+#define LWIP_NETIFAPI_H
+
+#endif
@@ -0,0 +1,14 @@
+/*
+ * 主机仿真替身：lwIP sockets
+ */
+#ifndef LWIP_SOCKETS_H
+#define LWIP_SOCKETS_H
+
+#include <sys/select.h>
+#include <sys/types.h>
+#include <sys/time.h>
+
+// 只有 MQTT 的 socket 是真的：可读时刻由 broker 替身按场景脚本给出
+int lwip_select(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptset, struct timeval *timeout);
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * 主机仿真替身：OHOS 启动宏
+ * SYS_RUN 在主机上注册为构造函数，由仿真器在内核启动后依次调用
+ */
+#ifndef OHOS_INIT_H
+#define OHOS_INIT_H
+
+typedef void (*SimAppEntry)(void);
+void sim_register_app(const char *name, SimAppEntry entry);
+
+#define SYS_RUN(func)                                                      \
+    __attribute__((constructor)) static void sim_sys_run_##func(void)      \
+    {                                                                      \
+        sim_register_app(#func, func);                                     \
+    }
+
+#define APP_FEATURE_INIT(func) SYS_RUN(func)
+
+#endif
@@ -0,0 +1,302 @@
+/*
+ * 超声波雷达主机仿真入口
+ *
+ * 直接包含 ../ultrasonic_radar.c：固件源码不做任何修改，
+ * 硬件与内核由 include/ 下的替身头文件和 sim_os.c / sim_hw.c 提供。
+ *
+ * 用法: radar_sim [-t 秒] [-s 倍速] [-q] [-d] [-b] [场景文件]
+ *   -t  虚拟运行时长 (默认 60 s)
+ *   -s  0 表示尽可能快 (默认)，N 表示虚拟时间以真实时间 N 倍速推进
+ *   -q  屏蔽固件 printf 输出
+ *   -d  结束时打印 OLED 面板内容
+ *   -b  只跑测距流水线基准 (浮点 vs 定点，主机周期数)，不启动仿真；
+ *       基准代码只在 -DRADAR_BENCH=1 时编译进来，用 make pipebench
+ *
+ * 二进制整帧上报在 broker 替身处用 host/sweep_decoder 解码，与帧池里的原帧逐项比对，
+ * 同时按 JSON 格式化同一帧，报告两种格式每帧的字节数。
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim.h"
+
+#include "../ultrasonic_radar.c"
+#include "../host/sweep_decoder.h"
+
+static int g_dumpPanel = 0;
+static const char *g_scenePath = "(none)";
+static struct timespec g_realT0;
+
+// 二进制上报的解码校验
+static SweepDecoder_t g_sweepDecoder;
+static struct
+{
+    uint32_t msgs;
+    uint32_t keyframes;
+    uint32_t errors;     // 解码失败
+    uint32_t mismatches; // 解码结果与原帧不符
+    uint32_t expired;    // 送出时原帧的槽位已被复用，无从比对 (发布队列积压过久)
+    uint64_t binBytes;
+    uint64_t keyBytes;
+    uint64_t jsonBytes;  // 同一帧按 JSON 格式化的长度
+} g_codecCheck;
+
+/* 解码结果与原帧是否一致 (测距时刻允许量化误差，超出上限时只要求不短于上限) */
+static int Sim_SweepMatches(const SweepDecoded_t *d, const RadarFrame_t *f)
+{
+    if (d->bins != RADAR_FRAME_BINS || d->seq != f->seq || d->endMs != f->endMs || d->dir != f->direction ||
+        d->fgCount != f->fgCount || d->objectCount != f->objectCount ||
+        memcmp(d->fgMask, f->fgMask, sizeof(f->fgMask)) != 0)
+        return 0;
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+    {
+        if (d->rangeMm[i] != f->rangeMm[i])
+            return 0;
+        int32_t age = f->stampMs[i] ? (int32_t)(f->endMs - f->stampMs[i]) : -1;
+        if ((age < 0) != (d->ageMs[i] < 0))
+            return 0;
+        if (age >= 0 && d->ageMs[i] < SWEEP_AGE_MAX * SWEEP_AGE_UNIT_MS &&
+            abs(age - d->ageMs[i]) > SWEEP_AGE_UNIT_MS / 2)
+            return 0;
+    }
+    for (int i = 0; i < f->objectCount; i++)
+    {
+        const RadarObject_t *o = &f->objects[i];
+        const SweepObject_t *p = &d->objects[i];
+        if (p->id != o->id || p->bearing != o->bearing || p->rangeMm != o->rangeMm || p->velMmS != o->velMmS ||
+            p->ttcMs != o->ttcMs)
+            return 0;
+    }
+    return 1;
+}
+
+/* broker 替身的发布钩子：解码二进制上报并与帧池中的原帧比对
+ * (报文经发布队列送出时 MQTT 任务可能已释放该帧，槽位被复用前内容不变，按 seq 仍能找到) */
+static void Sim_OnPublish(const char *topic, const uint8_t *payload, size_t len)
+{
+    if (strcmp(topic, MQTT_TOPIC_DATA) != 0 || len == 0 || payload[0] != SWEEP_MAGIC)
+        return;
+    static SweepDecoded_t d;
+    g_codecCheck.msgs++;
+    g_codecCheck.binBytes += len;
+    if (SweepDecoder_Feed(&g_sweepDecoder, payload, len, &d) != SWEEP_OK)
+    {
+        g_codecCheck.errors++;
+        return;
+    }
+    if (d.key)
+    {
+        g_codecCheck.keyframes++;
+        g_codecCheck.keyBytes += len;
+    }
+    const RadarFrame_t *f = NULL;
+    for (int i = 0; i < FRAME_POOL_SIZE; i++)
+    {
+        if (g_framePool[i].frame.seq == d.seq)
+            f = &g_framePool[i].frame;
+    }
+    if (f == NULL)
+    {
+        g_codecCheck.expired++;
+        return;
+    }
+    if (!Sim_SweepMatches(&d, f))
+    {
+        g_codecCheck.mismatches++;
+        return;
+    }
+    char json[MQTT_SWEEP_PAYLOAD];
+    RadarState_t st;
+    State_Read(&st);
+    g_codecCheck.jsonBytes += (uint64_t)Sweep_Format(f, &st, json, sizeof(json));
+}
+
+static void Sim_Report(void)
+{
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double realS = (double)(t1.tv_sec - g_realT0.tv_sec) + (double)(t1.tv_nsec - g_realT0.tv_nsec) / 1e9;
+    double simS = (double)sim_now_us() / 1e6;
+
+    fprintf(stdout, "\n==== radar_sim report ====\n");
+    fprintf(stdout, "  scene               : %s\n", g_scenePath);
+    fprintf(stdout, "  virtual time        : %.3f s (real %.3f s, x%.0f)\n", simS, realS,
+            realS > 0 ? simS / realS : 0.0);
+
+    fprintf(stdout, "-- threads --\n");
+    SimThreadStat_t th[32];
+    int n = sim_thread_stats(th, 32);
+    for (int i = 0; i < n; i++)
+    {
+        fprintf(stdout, "  %-18s prio %2d stack %5u  cpu %9.1f ms (%5.1f%%)  switches %llu\n", th[i].name,
+                th[i].priority, th[i].stackSize, (double)th[i].busyUs / 1000.0,
+                simS > 0 ? (double)th[i].busyUs / 1e4 / simS : 0.0, (unsigned long long)th[i].switches);
+    }
+
+    fprintf(stdout, "-- mutexes --\n");
+    SimMutexStat_t mx[16];
+    n = sim_mutex_stats(mx, 16);
+    for (int i = 0; i < n; i++)
+    {
+        fprintf(stdout, "  #%d (created by %s): acquires %llu, contended %llu, wait total %.1f ms, max %.1f ms\n", i,
+                mx[i].owner, (unsigned long long)mx[i].acquires, (unsigned long long)mx[i].contentions,
+                (double)mx[i].waitUs / 1000.0, (double)mx[i].maxWaitUs / 1000.0);
+    }
+    fprintf(stdout, "  state lock          : %u acquires, contended %u, wait %.1f ms (max %.1f ms), read retries %u\n",
+            g_stateLockStats.acquires, g_stateLockStats.contended, g_stateLockStats.waitUs / 1000.0,
+            g_stateLockStats.maxWaitUs / 1000.0, g_stateLockStats.readRetries);
+    fprintf(stdout, "  sr04 async          : %u pings, %u echoes, no echo %u, timeouts %u, in flight %.1f ms (CPU freed)\n",
+            g_sr04Stats.pings, g_sr04Stats.echoes, g_sr04Stats.noEcho, g_sr04Stats.timeouts,
+            g_sr04Stats.flightUs / 1000.0);
+    fprintf(stdout, "  sr04 busy retrigger : %u\n", g_sr04Stats.busyWaits);
+    for (int i = 0; i < GATE_COUNT; i++)
+    {
+        const GateStats_t *gs = &g_gateStats[i];
+        fprintf(stdout, "  gate %3u cm         : %u pings in %.1f s, %.2f pings/s\n", g_gateRangeCm[i], gs->pings,
+                gs->elapsedUs / 1e6, gs->elapsedUs ? gs->pings * 1e6 / gs->elapsedUs : 0.0);
+    }
+
+    for (int i = 0; i < SCAN_STRATEGY_COUNT; i++)
+    {
+        const RangingStats_t *ss = &g_scanStats[i];
+        fprintf(stdout, "  scan %-10s     : %u sweeps in %.1f s, %.1f sweeps/min, %.1f samples/sweep\n",
+                g_scanStrategyName[i], ss->sweeps, ss->elapsedUs / 1e6,
+                ss->elapsedUs ? ss->sweeps * 60e6 / ss->elapsedUs : 0.0,
+                ss->sweeps ? (double)ss->samples / ss->sweeps : 0.0);
+    }
+
+    const AlarmLatencyStats_t *al = &g_alarmLatency;
+    fprintf(stdout, "  alarm fast path     : %u confirmed, %u rejected, ping->output avg %.1f ms, max %.1f ms\n",
+            al->count, al->rejects, al->count ? al->sumUs / 1000.0 / al->count : 0.0, al->maxUs / 1000.0);
+    fprintf(stdout, "  alarm latency hist  :");
+    for (int i = 0; i < ALARM_HIST_BINS; i++)
+    {
+        if (i < ALARM_HIST_BINS - 1)
+            fprintf(stdout, " <%ums:%u", g_alarmHistEdgesMs[i], al->hist[i]);
+        else
+            fprintf(stdout, " >=%ums:%u", g_alarmHistEdgesMs[i - 1], al->hist[i]);
+    }
+    fprintf(stdout, "\n");
+    const BgStats_t *bs = &g_bgStats;
+    fprintf(stdout, "  background          : %s, learned %d/%d bins, foreground %u/%u samples (%.1f%%), absorbed %u, "
+            "mqtt skipped %u\n", g_bgEnabled ? "on" : "off", Bg_LearnedBins(), RADAR_FRAME_BINS, bs->foreground,
+            bs->samples, bs->samples ? bs->foreground * 100.0 / bs->samples : 0.0, bs->absorbed, bs->mqttSkipped);
+    const RenderStats_t *rs = &g_renderStats;
+    uint32_t spanMs = rs->lastMs - rs->firstMs;
+    fprintf(stdout, "  oled render         : %u frames, %.1f fps, draw avg %.0f cyc (max %u, host cycles)\n",
+            rs->frames, spanMs ? (rs->frames - 1) * 1000.0 / spanMs : 0.0,
+            rs->frames ? (double)rs->drawCycles / rs->frames : 0.0, rs->drawCyclesMax);
+    fprintf(stdout, "  oled flush          : avg %.0f B/frame (max %u), %.1f ms/frame, swap wait %.2f ms/frame\n",
+            rs->frames ? (double)rs->bytes / rs->frames : 0.0, rs->bytesMax,
+            rs->frames ? rs->refreshUs / 1000.0 / rs->frames : 0.0,
+            rs->frames ? rs->swapWaitUs / 1000.0 / rs->frames : 0.0);
+    if (g_codecCheck.msgs > 0)
+    {
+        uint32_t deltas = g_codecCheck.msgs - g_codecCheck.keyframes;
+        uint32_t compared = g_codecCheck.msgs - g_codecCheck.errors - g_codecCheck.mismatches - g_codecCheck.expired;
+        fprintf(stdout, "  sweep codec         : %u msgs (key %u), binary avg %.0f B/sweep (key %.0f, delta %.0f), "
+                "json %.0f B/sweep, decode errors %u, mismatches %u, expired %u\n", g_codecCheck.msgs, g_codecCheck.keyframes,
+                (double)g_codecCheck.binBytes / g_codecCheck.msgs,
+                g_codecCheck.keyframes ? (double)g_codecCheck.keyBytes / g_codecCheck.keyframes : 0.0,
+                deltas ? (double)(g_codecCheck.binBytes - g_codecCheck.keyBytes) / deltas : 0.0,
+                compared ? (double)g_codecCheck.jsonBytes / compared : 0.0, g_codecCheck.errors, g_codecCheck.mismatches,
+                g_codecCheck.expired);
+    }
+    MqttPubqStats_t qs;
+    MqttPubq_GetStats(&qs);
+    if (qs.queued > 0)
+        fprintf(stdout, "  mqtt publish queue  : queued %u, sent %u, dropped %u old + %u new, purged %u, send errors %u, "
+                "backlog max %u B, latency avg %.1f ms, max %.1f ms\n", qs.queued, qs.sent, qs.droppedOldest,
+                qs.droppedNewest, qs.purged, qs.sendErrors, qs.queuedBytesMax,
+                qs.sent ? (double)qs.latencySumUs / qs.sent / 1000.0 : 0.0, qs.latencyMaxUs / 1000.0);
+    NetServiceStats_t ns;
+    NetService_GetStats(&ns);
+    fprintf(stdout, "  net service         : %s, routed %u, unrouted %u, probe max %u, reconnects %u, wifi rejoins %u\n",
+            NetService_GetState() == NET_STATE_UP ? "up" : "down", ns.routed, ns.unrouted, ns.probeMax, ns.reconnects,
+            ns.wifiRejoins);
+    fprintf(stdout, "-- sector revisit (ms, avg/max) --\n");
+    for (int i = 0; i < SCAN_STRATEGY_COUNT; i++)
+    {
+        if (g_scanStats[i].elapsedUs == 0)
+            continue;
+        fprintf(stdout, "  %-10s          :", g_scanStrategyName[i]);
+        for (int sec = 0; sec < ADAPT_SECTOR_COUNT; sec++)
+        {
+            const RevisitStats_t *rs = &g_revisitStats[i][sec];
+            uint32_t n = rs->visits > 1 ? rs->visits - 1 : 0;
+            fprintf(stdout, " %4.0f/%-4u", n ? (double)rs->intervalMsSum / n : 0.0, rs->intervalMsMax);
+        }
+        fprintf(stdout, "\n");
+    }
+    fprintf(stdout, "  interest at end     :");
+    for (int sec = 0; sec < ADAPT_SECTOR_COUNT; sec++)
+        fprintf(stdout, " %9u", g_sectorInterest[sec]);
+    fprintf(stdout, "\n");
+
+    fprintf(stdout, "-- sweep frames --\n");
+    int freeSlots = 0;
+    for (int i = 0; i < FRAME_POOL_SIZE; i++)
+        freeSlots += (g_framePool[i].refs == 0);
+    fprintf(stdout, "  pool                : %d slots x %u B, free %d, exhausted %u, last seq %u\n",
+            FRAME_POOL_SIZE, (unsigned)sizeof(FrameSlot_t), freeSlots, g_framePoolExhausted,
+            g_frameLatest ? g_frameLatest->seq : 0);
+    for (int i = 0; i < FRAME_CONSUMER_COUNT; i++)
+    {
+        const FrameConsumer_t *c = &g_frameConsumers[i];
+        fprintf(stdout, "  %-8s            : recv %u, dropped %u, lag avg %.1f ms, max %u ms\n", c->name,
+                c->received, c->dropped, c->received ? (double)c->lagMsSum / c->received : 0.0, c->lagMsMax);
+    }
+    fflush(stdout);
+
+    sim_hw_report();
+    if (g_dumpPanel)
+        sim_hw_dump_panel();
+}
+
+static void Sim_Usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-t seconds] [-s speed] [-q] [-d] [-b] [scene]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    int i;
+    for (i = 1; i < argc && argv[i][0] == '-'; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            g_simCfg.durationUs = (uint64_t)(atof(argv[++i]) * 1e6);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            g_simCfg.speed = atof(argv[++i]);
+        else if (strcmp(argv[i], "-q") == 0)
+            g_simCfg.quiet = 1;
+        else if (strcmp(argv[i], "-d") == 0)
+            g_dumpPanel = 1;
+        else if (strcmp(argv[i], "-b") == 0)
+        {
+#if RADAR_BENCH
+            Bench_Run();
+            return 0;
+#else
+            fprintf(stderr, "-b needs a build with -DRADAR_BENCH=1 (make pipebench)\n");
+            return 1;
+#endif
+        }
+        else
+            Sim_Usage(argv[0]);
+    }
+    if (i < argc)
+    {
+        g_scenePath = argv[i];
+        if (sim_scene_load(g_scenePath) != 0)
+            return 1;
+    }
+    sim_hw_set_alarm_range(ALARM_DISTANCE_CM);
+    SweepDecoder_Init(&g_sweepDecoder);
+    g_simPublishHook = Sim_OnPublish;
+
+    clock_gettime(CLOCK_MONOTONIC, &g_realT0);
+    sim_run(Sim_Report);
+    return 0;
+}
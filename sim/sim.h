@@ -0,0 +1,65 @@
+/*
+ * 超声波雷达主机仿真：内核与硬件模型的内部接口
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_FOREVER UINT64_MAX
+
+/* ---------------- 虚拟时钟内核 (sim_os.c) ---------------- */
+typedef void (*SimEventFunc)(void *arg);
+
+typedef struct
+{
+    uint32_t tickHz;      // 系统节拍频率 (LiteOS-M Hi3861 默认 100Hz)
+    uint32_t timesliceUs; // 同优先级时间片
+    uint64_t durationUs;  // 仿真总时长
+    double speed;         // 0: 尽可能快; N: 虚拟时间为真实时间的 N 倍
+    int quiet;            // 屏蔽固件 printf
+    uint32_t lockHoldUs;  // 每次取得互斥锁后占用的 CPU 时间 (模拟临界区耗时，期间可被抢占)
+} SimConfig_t;
+
+extern SimConfig_t g_simCfg;
+
+uint64_t sim_now_us(void);
+void sim_busy_us(uint64_t us);  // 忙等：占用 CPU，期间中断照常发生
+void sim_sleep_us(uint64_t us); // 阻塞：让出 CPU
+void sim_event_at(uint64_t atUs, SimEventFunc fn, void *arg); // 定时事件，在"中断上下文"执行
+void sim_wake(void *obj);       // 唤醒等待 obj 的线程 (可在事件回调中调用)
+void sim_run(void (*report)(void));
+
+/* 统计导出 */
+typedef struct
+{
+    const char *name;
+    int priority;
+    uint32_t stackSize;
+    uint64_t busyUs;
+    uint64_t switches;
+} SimThreadStat_t;
+
+typedef struct
+{
+    const char *owner; // 首个获取者所在线程名，便于区分
+    uint64_t acquires;
+    uint64_t contentions;
+    uint64_t waitUs;
+    uint64_t maxWaitUs;
+} SimMutexStat_t;
+
+int sim_thread_stats(SimThreadStat_t *out, int max);
+int sim_mutex_stats(SimMutexStat_t *out, int max);
+
+/* ---------------- 场景与硬件模型 (sim_hw.c) ---------------- */
+int sim_scene_load(const char *path);
+void sim_hw_set_alarm_range(float cm);
+void sim_hw_report(void);
+void sim_hw_dump_panel(void);
+
+/* broker 替身收到每条发布时调用 (可为空)，供入口程序检查上报内容 */
+extern void (*g_simPublishHook)(const char *topic, const uint8_t *payload, size_t len);
+
+#endif
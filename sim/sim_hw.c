@@ -0,0 +1,1277 @@
+/*
+ * 超声波雷达主机仿真：场景脚本与外设模型
+ *
+ * - 舵机：50Hz PWM 帧对齐的死区 + 匀速转动 + 到位后的过冲衰减
+ * - HC-SR04：由舵机实际指向与场景障碍物决定回波，带噪声/丢波/毛刺；
+ *   TRIG 下降沿后按时间表产生 ECHO 电平边沿，GPIO 中断照常触发
+ * - OLED：SSD1306 页寻址模型，I2C 每字节按总线速率计时 (忙等)
+ * - 按键/WiFi/MQTT：按场景脚本注入事件，broker 替身记录发布流量
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bsp_key.h"
+#include "bsp_mqtt.h"
+#include "bsp_oled.h"
+#include "bsp_sg90.h"
+#include "bsp_sr04.h"
+#include "bsp_wifi.h"
+#include "cmsis_os2.h"
+#include "hi_gpio.h"
+#include "hi_io.h"
+#include "hi_pwm.h"
+#include "hi_time.h"
+#include "lwip/sockets.h"
+#include "sim.h"
+
+#define MAX_OBSTACLES 32
+#define MAX_KEYS 32
+#define MAX_MQTT_MSGS 32
+#define MAX_SUB_TOPICS 8
+#define SIM_MQTT_SOCKET 3 // broker 替身连接对应的 socket 号
+#define BEEP_GPIO HI_GPIO_IDX_7
+#define LED_GPIO HI_GPIO_IDX_2
+#define SIM_EARLY_ALARM_US 5000000ULL // 逼近目标在此时间内将进入危险距离时，提前鸣叫算有效预警
+
+typedef struct
+{
+    float angle;
+    float rangeCm;
+    float widthDeg;
+    float speedCmS; // 负值表示靠近
+    uint64_t fromUs;
+    uint64_t toUs;   // 0 表示一直存在
+    uint64_t dangerUs; // 进入告警距离的时刻，SIM_FOREVER 表示不会
+    int alarmed;
+} Obstacle_t;
+
+typedef struct
+{
+    uint64_t atUs;
+    uint8_t key;
+} KeyEvent_t;
+
+typedef struct
+{
+    uint64_t atUs;
+    char topic[64];
+    char payload[64];
+} MqttInject_t;
+
+/* ---------------- 场景参数 ---------------- */
+static Obstacle_t g_obs[MAX_OBSTACLES];
+static int g_obsCount = 0;
+static KeyEvent_t g_keys[MAX_KEYS];
+static int g_keyCount = 0, g_keyNext = 0;
+static MqttInject_t g_mqttIn[MAX_MQTT_MSGS];
+static int g_mqttInCount = 0, g_mqttInNext = 0;
+
+static struct
+{
+    float speedDegPerMs; // SG90 空载约 0.1s/60°
+    float frameMs;       // PWM 周期，新指令在下一帧生效
+    float settleMs;      // 到位后的机械振荡时间
+} g_servoCfg = {0.5f, 20.0f, 8.0f};
+
+static struct
+{
+    float beamDeg;  // 半波束角
+    float noiseCm;  // 高斯噪声标准差
+    float dropout;  // 丢波概率
+    float spike;    // 毛刺概率
+    uint32_t seed;
+} g_sr04Cfg = {15.0f, 0.5f, 0.02f, 0.01f, 1};
+
+static float g_i2cKHz = 400.0f;
+static float g_netKbps = 1000.0f;
+static float g_netRttMs = 40.0f;
+static float g_wifiMs = 2000.0f;
+static float g_netDropMs = -1.0f; // 服务器断开连接的时刻，<0 不断开
+static float g_apDropMs = -1.0f;  // 热点断开 (设备失去 IP) 的时刻，<0 不断开
+static float g_alarmRangeCm = 0;
+
+/* ---------------- 随机数 ---------------- */
+static uint64_t g_rng = 0x9E3779B97F4A7C15ULL;
+
+static double Rand01(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return (double)(g_rng >> 11) / (double)(1ULL << 53);
+}
+
+static double RandGauss(void)
+{
+    double u1 = Rand01(), u2 = Rand01();
+    if (u1 < 1e-12)
+        u1 = 1e-12;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/* ============================================================
+ * 场景脚本
+ * ============================================================ */
+static int KvFloat(const char *line, const char *key, float *out)
+{
+    char pat[32];
+    snprintf(pat, sizeof(pat), " %s=", key);
+    const char *p = strstr(line, pat);
+    if (p == NULL)
+        return 0;
+    *out = strtof(p + strlen(pat), NULL);
+    return 1;
+}
+
+static int KvStr(const char *line, const char *key, char *out, size_t len)
+{
+    char pat[32];
+    snprintf(pat, sizeof(pat), " %s=", key);
+    const char *p = strstr(line, pat);
+    if (p == NULL)
+        return 0;
+    p += strlen(pat);
+    size_t n = strcspn(p, " \t\r\n");
+    if (n >= len)
+        n = len - 1;
+    memcpy(out, p, n);
+    out[n] = '\0';
+    return 1;
+}
+
+static uint64_t MsToUs(float ms)
+{
+    return (uint64_t)(ms * 1000.0f);
+}
+
+static int KeyEvent_Cmp(const void *a, const void *b)
+{
+    uint64_t x = ((const KeyEvent_t *)a)->atUs, y = ((const KeyEvent_t *)b)->atUs;
+    return x < y ? -1 : (x > y);
+}
+
+static int MqttInject_Cmp(const void *a, const void *b)
+{
+    uint64_t x = ((const MqttInject_t *)a)->atUs, y = ((const MqttInject_t *)b)->atUs;
+    return x < y ? -1 : (x > y);
+}
+
+int sim_scene_load(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "[sim] cannot open scene %s\n", path);
+        return -1;
+    }
+    char raw[256];
+    while (fgets(raw, sizeof(raw), fp) != NULL)
+    {
+        char line[260];
+        snprintf(line, sizeof(line), " %s", raw); // 前置空格便于 " key=" 匹配
+        char *hash = strchr(line, '#');
+        if (hash != NULL)
+            *hash = '\0';
+        char kind[16] = {0};
+        if (sscanf(line, "%15s", kind) != 1)
+            continue;
+        float v;
+        if (strcmp(kind, "obstacle") == 0 && g_obsCount < MAX_OBSTACLES)
+        {
+            Obstacle_t *o = &g_obs[g_obsCount++];
+            memset(o, 0, sizeof(*o));
+            o->widthDeg = 4.0f;
+            KvFloat(line, "angle", &o->angle);
+            KvFloat(line, "range", &o->rangeCm);
+            KvFloat(line, "width", &o->widthDeg);
+            KvFloat(line, "speed", &o->speedCmS);
+            if (KvFloat(line, "from", &v))
+                o->fromUs = MsToUs(v);
+            if (KvFloat(line, "to", &v))
+                o->toUs = MsToUs(v);
+        }
+        else if (strcmp(kind, "key") == 0 && g_keyCount < MAX_KEYS)
+        {
+            KeyEvent_t *k = &g_keys[g_keyCount++];
+            if (KvFloat(line, "at", &v))
+                k->atUs = MsToUs(v);
+            k->key = KvFloat(line, "id", &v) ? (uint8_t)v : KEY1_PRESS;
+        }
+        else if (strcmp(kind, "mqtt") == 0 && g_mqttInCount < MAX_MQTT_MSGS)
+        {
+            MqttInject_t *m = &g_mqttIn[g_mqttInCount++];
+            if (KvFloat(line, "at", &v))
+                m->atUs = MsToUs(v);
+            KvStr(line, "topic", m->topic, sizeof(m->topic));
+            KvStr(line, "payload", m->payload, sizeof(m->payload));
+        }
+        else if (strcmp(kind, "servo") == 0)
+        {
+            KvFloat(line, "speed", &g_servoCfg.speedDegPerMs);
+            KvFloat(line, "frame", &g_servoCfg.frameMs);
+            KvFloat(line, "settle", &g_servoCfg.settleMs);
+        }
+        else if (strcmp(kind, "sr04") == 0)
+        {
+            KvFloat(line, "beam", &g_sr04Cfg.beamDeg);
+            KvFloat(line, "noise", &g_sr04Cfg.noiseCm);
+            KvFloat(line, "dropout", &g_sr04Cfg.dropout);
+            KvFloat(line, "spike", &g_sr04Cfg.spike);
+            if (KvFloat(line, "seed", &v))
+                g_sr04Cfg.seed = (uint32_t)v;
+        }
+        else if (strcmp(kind, "oled") == 0)
+        {
+            KvFloat(line, "i2c", &g_i2cKHz);
+        }
+        else if (strcmp(kind, "cpu") == 0)
+        {
+            if (KvFloat(line, "lock", &v))
+                g_simCfg.lockHoldUs = (uint32_t)v;
+        }
+        else if (strcmp(kind, "net") == 0)
+        {
+            KvFloat(line, "bandwidth", &g_netKbps);
+            KvFloat(line, "rtt", &g_netRttMs);
+            KvFloat(line, "wifi", &g_wifiMs);
+            KvFloat(line, "drop", &g_netDropMs);
+            KvFloat(line, "apdrop", &g_apDropMs);
+        }
+        else
+        {
+            fprintf(stderr, "[sim] unknown scene line: %s", raw);
+        }
+    }
+    fclose(fp);
+    qsort(g_keys, (size_t)g_keyCount, sizeof(g_keys[0]), KeyEvent_Cmp);
+    qsort(g_mqttIn, (size_t)g_mqttInCount, sizeof(g_mqttIn[0]), MqttInject_Cmp);
+    g_rng ^= (uint64_t)g_sr04Cfg.seed * 0x2545F4914F6CDD1DULL;
+    return 0;
+}
+
+static float Obstacle_RangeAt(const Obstacle_t *o, uint64_t t)
+{
+    float r = o->rangeCm + o->speedCmS * (float)(t - o->fromUs) / 1e6f;
+    return r < 2.0f ? 2.0f : r;
+}
+
+static int Obstacle_Active(const Obstacle_t *o, uint64_t t)
+{
+    return t >= o->fromUs && (o->toUs == 0 || t < o->toUs);
+}
+
+void sim_hw_set_alarm_range(float cm)
+{
+    g_alarmRangeCm = cm;
+    for (int i = 0; i < g_obsCount; i++)
+    {
+        Obstacle_t *o = &g_obs[i];
+        o->dangerUs = SIM_FOREVER;
+        if (o->rangeCm <= cm)
+            o->dangerUs = o->fromUs;
+        else if (o->speedCmS < 0)
+            o->dangerUs = o->fromUs + (uint64_t)((o->rangeCm - cm) / -o->speedCmS * 1e6f);
+        if (o->toUs != 0 && o->dangerUs >= o->toUs)
+            o->dangerUs = SIM_FOREVER;
+    }
+}
+
+/* ============================================================
+ * GPIO / IO / PWM
+ * ============================================================ */
+static struct
+{
+    hi_gpio_value level;
+    hi_gpio_dir dir;
+    gpio_isr_callback isr;
+    void *isrArg;
+    hi_gpio_int_polarity polarity;
+    int masked;
+    uint64_t lastRiseUs;
+} g_gpio[HI_GPIO_IDX_MAX];
+
+static uint8_t g_ioFunc[HI_IO_NAME_MAX];
+
+static struct
+{
+    uint64_t rises;
+    uint64_t onUs;
+    uint64_t lastOnUs;
+    uint64_t falseAlarms;
+    uint64_t latencySumUs;
+    uint64_t latencyMaxUs;
+    uint32_t latencyCount;
+    uint64_t earlyLeadSumUs; // 预警：鸣叫时刻距目标进入危险距离的提前量
+    uint64_t earlyLeadMinUs;
+    uint32_t earlyCount;
+} g_beep;
+
+static uint64_t g_ledToggles = 0;
+
+static void Sr04_OnTrigFall(void);
+
+static void Beep_Edge(int on)
+{
+    uint64_t now = sim_now_us();
+    if (on)
+    {
+        g_beep.rises++;
+        g_beep.lastOnUs = now;
+        int matched = 0;
+        for (int i = 0; i < g_obsCount; i++)
+        {
+            Obstacle_t *o = &g_obs[i];
+            if (o->dangerUs != SIM_FOREVER && o->dangerUs <= now && Obstacle_Active(o, now))
+            {
+                matched = 1;
+                if (!o->alarmed)
+                {
+                    uint64_t lat = now - o->dangerUs;
+                    o->alarmed = 1;
+                    g_beep.latencySumUs += lat;
+                    g_beep.latencyCount++;
+                    if (lat > g_beep.latencyMaxUs)
+                        g_beep.latencyMaxUs = lat;
+                }
+            }
+            else if (o->dangerUs != SIM_FOREVER && o->dangerUs > now && o->dangerUs - now <= SIM_EARLY_ALARM_US &&
+                     Obstacle_Active(o, now))
+            {
+                // 按接近速度提前告警 (碰撞时间)
+                matched = 1;
+                if (!o->alarmed)
+                {
+                    uint64_t lead = o->dangerUs - now;
+                    o->alarmed = 1;
+                    g_beep.earlyLeadSumUs += lead;
+                    if (g_beep.earlyCount == 0 || lead < g_beep.earlyLeadMinUs)
+                        g_beep.earlyLeadMinUs = lead;
+                    g_beep.earlyCount++;
+                }
+            }
+        }
+        if (!matched)
+            g_beep.falseAlarms++;
+    }
+    else
+    {
+        g_beep.onUs += now - g_beep.lastOnUs;
+    }
+}
+
+static void Gpio_SetLevel(hi_gpio_idx id, hi_gpio_value val)
+{
+    hi_gpio_value old = g_gpio[id].level;
+    g_gpio[id].level = val;
+    if (old == val)
+        return;
+    if (val == HI_GPIO_VALUE1)
+        g_gpio[id].lastRiseUs = sim_now_us();
+    if (g_gpio[id].isr != NULL && !g_gpio[id].masked &&
+        ((val == HI_GPIO_VALUE1) == (g_gpio[id].polarity == HI_GPIO_EDGE_RISE_LEVEL_HIGH)))
+    {
+        g_gpio[id].isr(g_gpio[id].isrArg);
+    }
+}
+
+hi_u32 hi_gpio_init(hi_void)
+{
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_gpio_set_dir(hi_gpio_idx id, hi_gpio_dir dir)
+{
+    if (id >= HI_GPIO_IDX_MAX)
+        return HI_ERR_FAILURE;
+    g_gpio[id].dir = dir;
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_gpio_set_ouput_val(hi_gpio_idx id, hi_gpio_value val)
+{
+    if (id >= HI_GPIO_IDX_MAX)
+        return HI_ERR_FAILURE;
+    hi_gpio_value old = g_gpio[id].level;
+    if (id == BEEP_GPIO && old != val)
+        Beep_Edge(val == HI_GPIO_VALUE1);
+    if (id == LED_GPIO && old != val)
+        g_ledToggles++;
+    Gpio_SetLevel(id, val);
+    if ((hi_io_name)id == SR04_TRIG_PIN && old == HI_GPIO_VALUE1 && val == HI_GPIO_VALUE0)
+        Sr04_OnTrigFall();
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_gpio_get_input_val(hi_gpio_idx id, hi_gpio_value *val)
+{
+    if (id >= HI_GPIO_IDX_MAX || val == NULL)
+        return HI_ERR_FAILURE;
+    *val = g_gpio[id].level;
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_gpio_register_isr_function(hi_gpio_idx id, hi_gpio_int_type int_type,
+                                     hi_gpio_int_polarity int_polarity,
+                                     gpio_isr_callback func, hi_char *arg)
+{
+    (void)int_type;
+    if (id >= HI_GPIO_IDX_MAX)
+        return HI_ERR_FAILURE;
+    g_gpio[id].isr = func;
+    g_gpio[id].isrArg = arg;
+    g_gpio[id].polarity = int_polarity;
+    g_gpio[id].masked = 0;
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_gpio_unregister_isr_function(hi_gpio_idx id)
+{
+    if (id >= HI_GPIO_IDX_MAX)
+        return HI_ERR_FAILURE;
+    g_gpio[id].isr = NULL;
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_gpio_set_isr_mode(hi_gpio_idx id, hi_gpio_int_type int_type, hi_gpio_int_polarity int_polarity)
+{
+    (void)int_type;
+    if (id >= HI_GPIO_IDX_MAX)
+        return HI_ERR_FAILURE;
+    g_gpio[id].polarity = int_polarity;
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_gpio_set_isr_mask(hi_gpio_idx id, hi_bool is_mask)
+{
+    if (id >= HI_GPIO_IDX_MAX)
+        return HI_ERR_FAILURE;
+    g_gpio[id].masked = is_mask;
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_io_set_func(hi_io_name id, hi_u8 val)
+{
+    if (id >= HI_IO_NAME_MAX)
+        return HI_ERR_FAILURE;
+    g_ioFunc[id] = val;
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_io_set_pull(hi_io_name id, hi_io_pull val)
+{
+    (void)val;
+    return id < HI_IO_NAME_MAX ? HI_ERR_SUCCESS : HI_ERR_FAILURE;
+}
+
+hi_u32 hi_pwm_init(hi_pwm_port port)
+{
+    return port < HI_PWM_PORT_MAX ? HI_ERR_SUCCESS : HI_ERR_FAILURE;
+}
+
+hi_u32 hi_pwm_deinit(hi_pwm_port port)
+{
+    return port < HI_PWM_PORT_MAX ? HI_ERR_SUCCESS : HI_ERR_FAILURE;
+}
+
+hi_u32 hi_pwm_set_clock(hi_pwm_clk_source clk_type)
+{
+    return clk_type < PWM_CLK_MAX ? HI_ERR_SUCCESS : HI_ERR_FAILURE;
+}
+
+hi_u32 hi_pwm_start(hi_pwm_port port, hi_u16 duty, hi_u16 freq)
+{
+    (void)freq;
+    // GPIO7 复用为 PWM0 时视作蜂鸣器发声
+    if (port == HI_PWM_PORT_PWM0 && g_ioFunc[HI_IO_NAME_GPIO_7] == HI_IO_FUNC_GPIO_7_PWM0_OUT)
+        hi_gpio_set_ouput_val(BEEP_GPIO, duty > 0 ? HI_GPIO_VALUE1 : HI_GPIO_VALUE0);
+    return port < HI_PWM_PORT_MAX ? HI_ERR_SUCCESS : HI_ERR_FAILURE;
+}
+
+hi_u32 hi_pwm_stop(hi_pwm_port port)
+{
+    if (port == HI_PWM_PORT_PWM0 && g_ioFunc[HI_IO_NAME_GPIO_7] == HI_IO_FUNC_GPIO_7_PWM0_OUT)
+        hi_gpio_set_ouput_val(BEEP_GPIO, HI_GPIO_VALUE0);
+    return port < HI_PWM_PORT_MAX ? HI_ERR_SUCCESS : HI_ERR_FAILURE;
+}
+
+void led_init(void)
+{
+    hi_gpio_set_dir(LED_GPIO, HI_GPIO_DIR_OUT);
+}
+
+void beep_init(void)
+{
+}
+
+/* 实验3 的调光 LED 与光敏 ADC (仅合并镜像使用) */
+static struct
+{
+    int inited;
+    uint16_t duty;
+    uint64_t sets;
+} g_pwmLed;
+
+void pwm_init(void)
+{
+    g_pwmLed.inited = 1;
+}
+
+void pwm_set_duty(uint16_t duty)
+{
+    g_pwmLed.duty = duty;
+    g_pwmLed.sets++;
+}
+
+void adc5_init(void)
+{
+}
+
+uint16_t get_adc5_value(void)
+{
+    sim_busy_us(20);
+    return (uint16_t)(1800 + sim_now_us() / 1000 % 64); // 不动测距噪声的随机序列
+}
+
+/* ============================================================
+ * SG90 舵机
+ * ============================================================ */
+// 一段运动：tStart (下一个 PWM 帧) 起从 pos0 匀速转向 target，到位后过冲衰减至 tSettled
+typedef struct
+{
+    float pos0;
+    float target;
+    float overshoot;
+    uint64_t tStart;
+    uint64_t tEnd;
+    uint64_t tSettled;
+} ServoSeg_t;
+
+static struct
+{
+    ServoSeg_t cur;
+    ServoSeg_t prev; // 新指令生效 (下一帧) 之前仍在执行的上一段
+    int lastDir;
+    uint32_t cmdsInRun;
+    uint64_t commands;
+    uint64_t sweeps;
+    uint64_t firstBoundaryUs;
+    uint64_t lastBoundaryUs;
+    uint64_t pingsAtBoundary;
+} g_servo = {{90.0f, 90.0f, 0, 0, 0, 0}, {90.0f, 90.0f, 0, 0, 0, 0}, 0, 0, 0, 0, 0, 0, 0};
+
+static uint64_t g_pings = 0;
+static double g_pingAimErrSum = 0; // 触发时刻波束实际指向与指令角度之差
+static float g_pingAimErrMax = 0;
+static uint64_t g_pingsMoving = 0; // 触发时舵机尚未稳定的次数
+
+static float Servo_SegPosAt(const ServoSeg_t *seg, uint64_t t)
+{
+    if (t < seg->tStart)
+        return seg->pos0;
+    if (t < seg->tEnd)
+        return seg->pos0 + (seg->target - seg->pos0) * (float)(t - seg->tStart) / (float)(seg->tEnd - seg->tStart);
+    if (t < seg->tSettled)
+        return seg->target + seg->overshoot * (float)(seg->tSettled - t) / (float)(seg->tSettled - seg->tEnd);
+    return seg->target;
+}
+
+static float Servo_PosAt(uint64_t t)
+{
+    return Servo_SegPosAt(t < g_servo.cur.tStart ? &g_servo.prev : &g_servo.cur, t);
+}
+
+void sg90_init(void)
+{
+}
+
+void set_sg90_angle(uint16_t angle)
+{
+    uint64_t now = sim_now_us();
+    float target = angle > 180 ? 180.0f : (float)angle;
+
+    // 扫描圈数统计：指令方向反转即一次扫描结束
+    float cmdDelta = target - g_servo.cur.target;
+    int dir = cmdDelta > 0 ? 1 : (cmdDelta < 0 ? -1 : 0);
+    g_servo.commands++;
+    if (dir != 0)
+    {
+        if (dir != g_servo.lastDir && g_servo.lastDir != 0)
+        {
+            if (g_servo.cmdsInRun >= 3)
+            {
+                if (g_servo.sweeps == 0 && g_servo.firstBoundaryUs == 0)
+                {
+                    g_servo.firstBoundaryUs = now;
+                    g_servo.pingsAtBoundary = g_pings;
+                }
+                else
+                {
+                    g_servo.sweeps++;
+                    g_servo.lastBoundaryUs = now;
+                }
+            }
+            g_servo.cmdsInRun = 0;
+        }
+        g_servo.lastDir = dir;
+        g_servo.cmdsInRun++;
+    }
+
+    uint64_t frameUs = MsToUs(g_servoCfg.frameMs);
+    // 新脉宽在下一帧才生效，在此之前舵机继续执行正在进行的那段运动；
+    // 同一帧内的多次指令只有最后一次生效
+    uint64_t tStart = frameUs > 0 ? (now / frameUs + 1) * frameUs : now;
+    if (now >= g_servo.cur.tStart)
+        g_servo.prev = g_servo.cur;
+    ServoSeg_t *seg = &g_servo.cur;
+    seg->pos0 = Servo_SegPosAt(&g_servo.prev, tStart);
+    float delta = target - seg->pos0;
+    seg->target = target;
+    seg->tStart = tStart;
+    seg->tEnd = tStart + (uint64_t)(fabsf(delta) / g_servoCfg.speedDegPerMs * 1000.0f);
+    seg->tSettled = seg->tEnd + MsToUs(g_servoCfg.settleMs);
+    float os = fabsf(delta) * 0.05f;
+    if (os > 3.0f)
+        os = 3.0f;
+    seg->overshoot = delta >= 0 ? os : -os;
+}
+
+/* ============================================================
+ * HC-SR04
+ * ============================================================ */
+#define SR04_BURST_US 460    // TRIG 下降沿到 ECHO 上升沿 (8 个 40kHz 脉冲)
+#define SR04_NO_ECHO_US 38000 // 无回波时模块自身的超时脉宽
+#define SR04_US_PER_CM 58.3f
+
+static struct
+{
+    int busy;
+    uint64_t riseUs;
+    uint64_t fallUs;
+    uint64_t ignoredTriggers;
+    uint64_t noEcho;
+} g_sr04;
+
+static void Sr04_EchoRise(void *arg)
+{
+    (void)arg;
+    Gpio_SetLevel((hi_gpio_idx)SR04_ECHO_PIN, HI_GPIO_VALUE1);
+}
+
+static void Sr04_EchoFall(void *arg)
+{
+    (void)arg;
+    g_sr04.busy = 0;
+    Gpio_SetLevel((hi_gpio_idx)SR04_ECHO_PIN, HI_GPIO_VALUE0);
+}
+
+static uint32_t Sr04_EchoUs(uint64_t t)
+{
+    float beam = Servo_PosAt(t);
+    float nearest = 1e9f;
+    for (int i = 0; i < g_obsCount; i++)
+    {
+        const Obstacle_t *o = &g_obs[i];
+        if (!Obstacle_Active(o, t))
+            continue;
+        if (fabsf(o->angle - beam) > g_sr04Cfg.beamDeg + o->widthDeg / 2)
+            continue;
+        float r = Obstacle_RangeAt(o, t);
+        if (r < nearest)
+            nearest = r;
+    }
+    if (Rand01() < g_sr04Cfg.dropout)
+        return SR04_NO_ECHO_US;
+    if (Rand01() < g_sr04Cfg.spike)
+        nearest = 2.0f + (float)Rand01() * 398.0f;
+    if (nearest > 400.0f)
+        return SR04_NO_ECHO_US;
+    nearest += (float)RandGauss() * g_sr04Cfg.noiseCm;
+    if (nearest < 2.0f)
+        nearest = 2.0f;
+    return (uint32_t)(nearest * SR04_US_PER_CM);
+}
+
+static void Sr04_OnTrigFall(void)
+{
+    uint64_t now = sim_now_us();
+    if (g_sr04.busy || now - g_gpio[SR04_TRIG_PIN].lastRiseUs < 10)
+    {
+        g_sr04.ignoredTriggers++;
+        return;
+    }
+    uint32_t echoUs = Sr04_EchoUs(now);
+    if (echoUs >= SR04_NO_ECHO_US)
+        g_sr04.noEcho++;
+    g_pings++;
+    float aimErr = fabsf(Servo_PosAt(now) - g_servo.cur.target);
+    g_pingAimErrSum += aimErr;
+    if (aimErr > g_pingAimErrMax)
+        g_pingAimErrMax = aimErr;
+    if (now < g_servo.cur.tSettled)
+        g_pingsMoving++;
+    g_sr04.busy = 1;
+    g_sr04.riseUs = now + SR04_BURST_US;
+    g_sr04.fallUs = g_sr04.riseUs + echoUs;
+    sim_event_at(g_sr04.riseUs, Sr04_EchoRise, NULL);
+    sim_event_at(g_sr04.fallUs, Sr04_EchoFall, NULL);
+}
+
+void sr04_init(void)
+{
+    hi_gpio_set_dir((hi_gpio_idx)SR04_TRIG_PIN, HI_GPIO_DIR_OUT);
+    hi_gpio_set_dir((hi_gpio_idx)SR04_ECHO_PIN, HI_GPIO_DIR_IN);
+}
+
+/* 与 bsp 驱动相同：触发后忙等 ECHO 高电平结束 */
+float sr04_read_distance(void)
+{
+    hi_gpio_set_ouput_val((hi_gpio_idx)SR04_TRIG_PIN, HI_GPIO_VALUE1);
+    hi_udelay(20);
+    hi_gpio_set_ouput_val((hi_gpio_idx)SR04_TRIG_PIN, HI_GPIO_VALUE0);
+    uint64_t rise = g_sr04.riseUs, fall = g_sr04.fallUs;
+    uint64_t now = sim_now_us();
+    if (fall > now)
+        sim_busy_us(fall - now);
+    return (float)(fall - rise) * 0.034f / 2;
+}
+
+/* ============================================================
+ * OLED (SSD1306 页寻址)
+ * ============================================================ */
+static uint8_t g_gram[8][128];
+static uint8_t g_panel[8][128];
+static struct
+{
+    uint8_t page;
+    uint8_t col;
+    uint64_t bytes;
+    uint64_t refreshes;
+} g_oled;
+
+void oled_wr_byte(uint8_t dat, uint8_t cmd)
+{
+    // 每次写入是一次 I2C 事务：地址 + 控制字节 + 数据，每字节 9 位
+    sim_busy_us((uint64_t)(3 * 9 * 1000.0f / g_i2cKHz));
+    g_oled.bytes++;
+    if (cmd == OLED_DATA)
+    {
+        g_panel[g_oled.page & 7][g_oled.col & 127] = dat;
+        g_oled.col = (g_oled.col + 1) & 127;
+    }
+    else if ((dat & 0xF0) == 0xB0)
+    {
+        g_oled.page = dat & 0x07;
+    }
+    else if ((dat & 0xF0) == 0x00)
+    {
+        g_oled.col = (g_oled.col & 0xF0) | (dat & 0x0F);
+    }
+    else if ((dat & 0xF0) == 0x10)
+    {
+        g_oled.col = (uint8_t)((g_oled.col & 0x0F) | ((dat & 0x0F) << 4));
+    }
+}
+
+void oled_init(void)
+{
+    memset(g_gram, 0, sizeof(g_gram));
+}
+
+void oled_display_on(void)
+{
+    oled_wr_byte(0xAF, OLED_CMD);
+}
+
+void oled_display_off(void)
+{
+    oled_wr_byte(0xAE, OLED_CMD);
+}
+
+void oled_refresh_gram(void)
+{
+    g_oled.refreshes++;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        oled_wr_byte(0xB0 + i, OLED_CMD);
+        oled_wr_byte(0x00, OLED_CMD);
+        oled_wr_byte(0x10, OLED_CMD);
+        for (uint8_t n = 0; n < 128; n++)
+            oled_wr_byte(g_gram[i][n], OLED_DATA);
+    }
+}
+
+void oled_clear(void)
+{
+    memset(g_gram, 0, sizeof(g_gram));
+}
+
+void oled_drawpoint(uint8_t x, uint8_t y, uint8_t t)
+{
+    if (x > 127 || y > 63)
+        return;
+    if (t)
+        g_gram[y / 8][x] |= (uint8_t)(1 << (y % 8));
+    else
+        g_gram[y / 8][x] &= (uint8_t)~(1 << (y % 8));
+}
+
+void oled_draw_bigpoint(uint8_t x, uint8_t y, uint8_t t)
+{
+    for (int dx = -1; dx <= 1; dx++)
+        for (int dy = -1; dy <= 1; dy++)
+            oled_drawpoint((uint8_t)(x + dx), (uint8_t)(y + dy), t);
+}
+
+void oled_drawline(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t t)
+{
+    int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    int x = x1, y = y1;
+    for (;;)
+    {
+        oled_drawpoint((uint8_t)x, (uint8_t)y, t);
+        if (x == x2 && y == y2)
+            break;
+        int e2 = 2 * err;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y += sy;
+        }
+    }
+}
+
+void oled_fill(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t dot)
+{
+    for (uint8_t x = x1; x <= x2 && x < 128; x++)
+        for (uint8_t y = y1; y <= y2 && y < 64; y++)
+            oled_drawpoint(x, y, dot);
+}
+
+/* 仿真不带字库：字符以实心块占位，足够观察布局 */
+void oled_showchar(uint8_t x, uint8_t y, uint8_t chr, uint8_t size, uint8_t mode)
+{
+    uint8_t w = size / 2;
+    for (uint8_t i = 1; i + 1 < w; i++)
+        for (uint8_t j = 2; j + 2 < size; j++)
+            oled_drawpoint((uint8_t)(x + i), (uint8_t)(y + j), chr != ' ' ? mode : !mode);
+}
+
+void oled_shownum(uint8_t x, uint8_t y, uint32_t num, uint8_t len, uint8_t size)
+{
+    for (uint8_t i = 0; i < len; i++)
+    {
+        oled_showchar((uint8_t)(x + (size / 2) * i), y, (uint8_t)('0' + num % 10), size, 1);
+        num /= 10;
+    }
+}
+
+void oled_showstring(uint8_t x, uint8_t y, const uint8_t *p, uint8_t size)
+{
+    while (*p != '\0' && x <= 128 - size / 2)
+    {
+        oled_showchar(x, y, *p, size, 1);
+        x += size / 2;
+        p++;
+    }
+}
+
+/* ============================================================
+ * 按键
+ * ============================================================ */
+void key_init(void)
+{
+}
+
+uint8_t key_scan(uint8_t mode)
+{
+    (void)mode;
+    if (g_keyNext < g_keyCount && g_keys[g_keyNext].atUs <= sim_now_us())
+        return g_keys[g_keyNext++].key;
+    return 0;
+}
+
+/* ============================================================
+ * WiFi
+ * ============================================================ */
+static uint64_t g_wifiUpUs = SIM_FOREVER;
+static uint64_t g_wifiDrops = 0;
+
+/* 场景里的 apdrop=：到点后设备失去 IP，TCP 连接随之断开 (见 Mqtt_CheckDrop)，
+ * 直到设备再次调用 WiFi_connectHotspots() */
+static void Wifi_CheckDrop(void)
+{
+    if (g_apDropMs >= 0 && sim_now_us() >= MsToUs(g_apDropMs))
+    {
+        g_wifiUpUs = SIM_FOREVER;
+        g_wifiDrops++;
+        g_apDropMs = -1.0f;
+    }
+}
+
+WifiErrorCode WiFi_connectHotspots(const char *ssid, const char *psk)
+{
+    (void)ssid;
+    (void)psk;
+    g_wifiUpUs = sim_now_us() + MsToUs(g_wifiMs);
+    sim_sleep_us(MsToUs(g_wifiMs) / 4);
+    return WIFI_SUCCESS;
+}
+
+char *WiFi_GetLocalIP(void)
+{
+    static char ip[16];
+    Wifi_CheckDrop();
+    snprintf(ip, sizeof(ip), "%s", sim_now_us() >= g_wifiUpUs ? "192.168.3.100" : "0.0.0.0");
+    return ip;
+}
+
+/* ============================================================
+ * MQTT broker 替身
+ * ============================================================ */
+int8_t (*p_MQTTClient_sub_callback)(unsigned char *topic, unsigned char *payload) = NULL;
+
+static struct
+{
+    int connected;
+    char topics[MAX_SUB_TOPICS][64];
+    int topicCount;
+    uint64_t pubMsgs;
+    uint64_t pubBytes;
+    uint64_t pubBlockedUs;
+    uint64_t firstPubUs;
+    uint64_t delivered;
+    uint64_t subCalls;
+    uint64_t cmdLatencySumUs; // 指令到达设备 → 回调执行完毕
+    uint64_t cmdLatencyMaxUs;
+    int broken;        // 服务器已断开，设备还没发现/重连
+    int inCall;        // 正在 MQTTClient_* 里的调用数
+    uint64_t overlaps; // 两个线程同时在客户端里 (同一条 TCP 流上两个写者)
+    uint64_t drops;
+    uint64_t connects;
+    uint64_t lost; // 断开期间到达、被服务器丢掉的消息
+} g_mqtt;
+
+static uint64_t NetTxUs(size_t bytes)
+{
+    return (uint64_t)((double)bytes * 8.0 * 1000.0 / g_netKbps);
+}
+
+/* bsp_mqtt 没有锁：同一时刻只能有一个线程在客户端里，否则报文会在 TCP 流里交错 */
+static void Mqtt_Enter(void)
+{
+    if (g_mqtt.inCall++ > 0)
+        g_mqtt.overlaps++;
+}
+
+static void Mqtt_Leave(void)
+{
+    g_mqtt.inCall--;
+}
+
+/* 场景里的 drop=：到点后服务器断开连接，之后的读写都失败，直到设备重新连接。
+ * 热点断开 (apdrop=) 时连接同样断开 */
+static void Mqtt_CheckDrop(void)
+{
+    Wifi_CheckDrop();
+    int linkDown = sim_now_us() < g_wifiUpUs;
+    int serverDrop = g_netDropMs >= 0 && sim_now_us() >= MsToUs(g_netDropMs);
+    if (g_mqtt.connected && !g_mqtt.broken && (linkDown || serverDrop))
+    {
+        g_mqtt.broken = 1;
+        g_mqtt.topicCount = 0;
+        g_mqtt.drops++;
+        if (serverDrop)
+            g_netDropMs = -1.0f;
+    }
+}
+
+int MQTTClient_connectServer(const char *ip_addr, int ip_port)
+{
+    (void)ip_addr;
+    (void)ip_port;
+    if (sim_now_us() < g_wifiUpUs)
+        return -1;
+    Mqtt_Enter();
+    sim_sleep_us(MsToUs(g_netRttMs) * 3 / 2); // TCP 三次握手
+    Mqtt_Leave();
+    g_mqtt.connected = 1;
+    g_mqtt.broken = 0;
+    g_mqtt.topicCount = 0;
+    if (g_mqtt.connects++ > 0)
+    {
+        // 重连：断开期间到达的消息服务器不会补发 (QoS 0)
+        while (g_mqttInNext < g_mqttInCount && g_mqttIn[g_mqttInNext].atUs <= sim_now_us())
+        {
+            g_mqttInNext++;
+            g_mqtt.lost++;
+        }
+    }
+    return 0;
+}
+
+int MQTTClient_init(char *clientID, char *userName, char *password)
+{
+    (void)clientID;
+    (void)userName;
+    (void)password;
+    if (!g_mqtt.connected)
+        return -1;
+    Mqtt_Enter();
+    sim_sleep_us(MsToUs(g_netRttMs)); // CONNECT/CONNACK
+    Mqtt_Leave();
+    return 0;
+}
+
+int MQTTClient_subscribe(char *subTopic)
+{
+    Mqtt_CheckDrop();
+    if (!g_mqtt.connected || g_mqtt.broken || g_mqtt.topicCount >= MAX_SUB_TOPICS)
+        return -1;
+    snprintf(g_mqtt.topics[g_mqtt.topicCount++], sizeof(g_mqtt.topics[0]), "%s", subTopic);
+    Mqtt_Enter();
+    sim_sleep_us(MsToUs(g_netRttMs)); // SUBSCRIBE/SUBACK
+    Mqtt_Leave();
+    return 0;
+}
+
+void MQTTClient_unsubscribe(char *topic)
+{
+    for (int i = 0; i < g_mqtt.topicCount; i++)
+    {
+        if (strcmp(g_mqtt.topics[i], topic) == 0)
+        {
+            g_mqtt.topics[i][0] = '\0';
+        }
+    }
+}
+
+void MQTTClient_disconnect(void)
+{
+    g_mqtt.connected = 0;
+    g_mqtt.broken = 0;
+}
+
+void (*g_simPublishHook)(const char *topic, const uint8_t *payload, size_t len) = NULL;
+
+int MQTTClient_pub(char *pub_Topic, unsigned char *payloadData, size_t payloadLen)
+{
+    Mqtt_CheckDrop();
+    if (!g_mqtt.connected || g_mqtt.broken)
+        return -1;
+    size_t pkt = 2 + 2 + strlen(pub_Topic) + payloadLen;
+    if (g_simPublishHook != NULL)
+        g_simPublishHook(pub_Topic, payloadData, payloadLen);
+    if (g_mqtt.pubMsgs == 0)
+        g_mqtt.firstPubUs = sim_now_us();
+    g_mqtt.pubMsgs++;
+    g_mqtt.pubBytes += pkt;
+    Mqtt_Enter();
+    sim_busy_us(100); // 序列化 + lwIP 拷贝
+    uint64_t blocked = NetTxUs(pkt);
+    g_mqtt.pubBlockedUs += blocked;
+    sim_sleep_us(blocked); // 阻塞 socket：等待发送窗口
+    Mqtt_Leave();
+    return 0;
+}
+
+static int Mqtt_Subscribed(const char *topic)
+{
+    for (int i = 0; i < g_mqtt.topicCount; i++)
+    {
+        if (strcmp(g_mqtt.topics[i], topic) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+int MQTTClient_sub(void)
+{
+    Mqtt_CheckDrop();
+    if (!g_mqtt.connected || g_mqtt.broken)
+        return -1;
+    g_mqtt.subCalls++;
+    Mqtt_Enter();
+    sim_busy_us(50);
+    Mqtt_Leave();
+    while (g_mqttInNext < g_mqttInCount && g_mqttIn[g_mqttInNext].atUs <= sim_now_us())
+    {
+        MqttInject_t *m = &g_mqttIn[g_mqttInNext++];
+        if (!Mqtt_Subscribed(m->topic) || p_MQTTClient_sub_callback == NULL)
+            continue;
+        g_mqtt.delivered++;
+        unsigned char topic[64], payload[64];
+        memcpy(topic, m->topic, sizeof(topic));
+        memcpy(payload, m->payload, sizeof(payload));
+        p_MQTTClient_sub_callback(topic, payload);
+        uint64_t latency = sim_now_us() - m->atUs;
+        g_mqtt.cmdLatencySumUs += latency;
+        if (latency > g_mqtt.cmdLatencyMaxUs)
+            g_mqtt.cmdLatencyMaxUs = latency;
+        break;
+    }
+    return 0;
+}
+
+int MQTTClient_getSocket(void)
+{
+    return g_mqtt.connected ? SIM_MQTT_SOCKET : -1;
+}
+
+/* 下一条会送到设备的消息的到达时刻 (未订阅主题的消息 broker 不会转发) */
+static uint64_t Mqtt_NextArrivalUs(void)
+{
+    for (int i = g_mqttInNext; i < g_mqttInCount; i++)
+    {
+        if (Mqtt_Subscribed(g_mqttIn[i].topic))
+            return g_mqttIn[i].atUs;
+    }
+    return SIM_FOREVER;
+}
+
+int lwip_select(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptset, struct timeval *timeout)
+{
+    (void)writeset;
+    (void)exceptset;
+    sim_busy_us(20);
+    uint64_t now = sim_now_us();
+    uint64_t deadline = timeout != NULL ? now + (uint64_t)timeout->tv_sec * 1000000 + (uint64_t)timeout->tv_usec
+                                        : SIM_FOREVER;
+    int watch = readset != NULL && g_mqtt.connected && SIM_MQTT_SOCKET < maxfdp1 && FD_ISSET(SIM_MQTT_SOCKET, readset);
+    uint64_t ready = SIM_FOREVER;
+    if (watch)
+    {
+        // 服务器断开后 socket 立即可读 (读到 EOF)
+        Mqtt_CheckDrop();
+        ready = g_mqtt.broken ? now : Mqtt_NextArrivalUs();
+        if (g_netDropMs >= 0 && MsToUs(g_netDropMs) < ready)
+            ready = MsToUs(g_netDropMs) > now ? MsToUs(g_netDropMs) : now;
+    }
+    if (readset != NULL)
+        FD_ZERO(readset);
+    if (ready == SIM_FOREVER || ready > deadline)
+    {
+        if (deadline == SIM_FOREVER)
+            for (;;)
+                sim_sleep_us(1000000); // 无超时且不会再有数据：永远阻塞
+        sim_sleep_us(deadline - now);
+        return 0;
+    }
+    if (ready > now)
+        sim_sleep_us(ready - now);
+    FD_SET(SIM_MQTT_SOCKET, readset);
+    return 1;
+}
+
+/* ============================================================
+ * 报告
+ * ============================================================ */
+static void DumpPanel(void)
+{
+    printf("  OLED panel (what the I2C bus last delivered):\n");
+    for (int y = 0; y < 64; y += 2)
+    {
+        printf("  |");
+        for (int x = 0; x < 128; x++)
+        {
+            int top = (g_panel[y / 8][x] >> (y % 8)) & 1;
+            int bot = (g_panel[(y + 1) / 8][x] >> ((y + 1) % 8)) & 1;
+            putchar(top && bot ? '8' : (top ? '\'' : (bot ? '.' : ' ')));
+        }
+        printf("|\n");
+    }
+}
+
+void sim_hw_report(void)
+{
+    double simS = (double)sim_now_us() / 1e6;
+    printf("-- scan --\n");
+    printf("  servo commands      : %llu\n", (unsigned long long)g_servo.commands);
+    double sweepS = (double)(g_servo.lastBoundaryUs - g_servo.firstBoundaryUs) / 1e6;
+    if (g_servo.sweeps > 0 && sweepS > 0)
+    {
+        uint64_t pingsInSweeps = 0;
+        // 只统计完整扫描期间的测距次数
+        pingsInSweeps = g_pings - g_servo.pingsAtBoundary;
+        printf("  full sweeps         : %llu\n", (unsigned long long)g_servo.sweeps);
+        printf("  sweeps/s            : %.3f\n", (double)g_servo.sweeps / sweepS);
+        printf("  sweep period        : %.1f ms\n", sweepS * 1000.0 / (double)g_servo.sweeps);
+        printf("  samples/sweep       : %.2f\n", (double)pingsInSweeps / (double)g_servo.sweeps);
+    }
+    else
+    {
+        printf("  full sweeps         : 0\n");
+    }
+    printf("  pings               : %llu (%.2f /s), no echo %llu, ignored triggers %llu\n",
+           (unsigned long long)g_pings, (double)g_pings / simS, (unsigned long long)g_sr04.noEcho,
+           (unsigned long long)g_sr04.ignoredTriggers);
+    if (g_pings > 0)
+        printf("  aim error at ping   : mean %.2f deg, max %.2f deg, before settle %llu (%.1f%%)\n",
+               g_pingAimErrSum / (double)g_pings, g_pingAimErrMax, (unsigned long long)g_pingsMoving,
+               100.0 * (double)g_pingsMoving / (double)g_pings);
+
+    printf("-- alarm (BEEP on GPIO7, danger range %.0f cm) --\n", g_alarmRangeCm);
+    int dangerEvents = 0, missed = 0;
+    for (int i = 0; i < g_obsCount; i++)
+    {
+        if (g_obs[i].dangerUs != SIM_FOREVER && g_obs[i].dangerUs < sim_now_us())
+        {
+            dangerEvents++;
+            if (!g_obs[i].alarmed)
+                missed++;
+        }
+    }
+    printf("  danger events       : %d, alarmed %u (early %u), missed %d\n", dangerEvents,
+           g_beep.latencyCount + g_beep.earlyCount, g_beep.earlyCount, missed);
+    if (g_beep.latencyCount > 0)
+        printf("  alarm latency       : mean %.1f ms, max %.1f ms\n",
+               (double)g_beep.latencySumUs / g_beep.latencyCount / 1000.0, (double)g_beep.latencyMaxUs / 1000.0);
+    if (g_beep.earlyCount > 0)
+        printf("  early warning lead  : mean %.1f ms, min %.1f ms\n",
+               (double)g_beep.earlyLeadSumUs / g_beep.earlyCount / 1000.0, (double)g_beep.earlyLeadMinUs / 1000.0);
+    printf("  beep rises          : %llu (false %llu), LED toggles %llu\n", (unsigned long long)g_beep.rises,
+           (unsigned long long)g_beep.falseAlarms, (unsigned long long)g_ledToggles);
+    if (g_gpio[BEEP_GPIO].level == HI_GPIO_VALUE1 || g_gpio[LED_GPIO].level == HI_GPIO_VALUE1)
+        printf("  alarm output at end : beep %s, LED %s (beep last rose at %.3f s)\n",
+               g_gpio[BEEP_GPIO].level == HI_GPIO_VALUE1 ? "on" : "off",
+               g_gpio[LED_GPIO].level == HI_GPIO_VALUE1 ? "on" : "off", (double)g_beep.lastOnUs / 1e6);
+
+    printf("-- display --\n");
+    printf("  full refreshes      : %llu (%.2f /s), I2C writes %llu (%.0f B/s)\n",
+           (unsigned long long)g_oled.refreshes, (double)g_oled.refreshes / simS,
+           (unsigned long long)g_oled.bytes, (double)g_oled.bytes / simS);
+
+    printf("-- mqtt --\n");
+    printf("  published           : %llu msgs (%.2f /s), %llu bytes, blocked %.1f ms\n",
+           (unsigned long long)g_mqtt.pubMsgs, (double)g_mqtt.pubMsgs / simS, (unsigned long long)g_mqtt.pubBytes,
+           (double)g_mqtt.pubBlockedUs / 1000.0);
+    if (g_mqtt.overlaps > 0)
+        printf("  client overlaps     : %llu (two threads inside bsp_mqtt at once)\n",
+               (unsigned long long)g_mqtt.overlaps);
+    if (g_mqtt.drops > 0)
+        printf("  connection drops    : %llu (ap %llu), connects %llu, messages lost while down %llu\n",
+               (unsigned long long)g_mqtt.drops, (unsigned long long)g_wifiDrops, (unsigned long long)g_mqtt.connects,
+               (unsigned long long)g_mqtt.lost);
+    printf("  commands delivered  : %llu", (unsigned long long)g_mqtt.delivered);
+    if (g_mqtt.delivered > 0)
+        printf(", latency mean %.1f ms, max %.1f ms", (double)g_mqtt.cmdLatencySumUs / g_mqtt.delivered / 1000.0,
+               (double)g_mqtt.cmdLatencyMaxUs / 1000.0);
+    printf("\n  receive wakeups     : %llu (%.2f /s)\n", (unsigned long long)g_mqtt.subCalls,
+           (double)g_mqtt.subCalls / simS);
+    if (g_pwmLed.inited)
+        printf("  led pwm (lab3)      : %llu duty changes, last duty %u\n", (unsigned long long)g_pwmLed.sets,
+               g_pwmLed.duty);
+}
+
+void sim_hw_dump_panel(void)
+{
+    DumpPanel();
+}
@@ -0,0 +1,1068 @@
+/*
+ * 超声波雷达主机仿真：虚拟时钟上的 CMSIS-RTOS2 内核
+ *
+ * 每个 osThread 对应一个 pthread，但任意时刻只有一个线程持有"CPU"。
+ * 线程只在调用内核接口时让出 CPU；没有就绪线程时虚拟时钟直接跳到下一个
+ * 超时点或定时事件，因此仿真可以远快于真实时间。
+ * 调度语义对齐 LiteOS-M：高优先级抢占、同优先级时间片轮转、延时按节拍对齐。
+ */
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmsis_os2.h"
+#include "hi_hrtimer.h"
+#include "hi_time.h"
+#include "ohos_init.h"
+#include "sim.h"
+
+SimConfig_t g_simCfg = {
+    .tickHz = 100,
+    .timesliceUs = 20 * 1000,
+    .durationUs = 60ULL * 1000 * 1000,
+    .speed = 0,
+    .quiet = 0,
+};
+
+typedef enum
+{
+    TH_READY = 0,
+    TH_RUNNING,
+    TH_WAITING,
+    TH_DONE
+} ThState_t;
+
+typedef struct SimThread
+{
+    pthread_t pt;
+    pthread_cond_t cv;
+    char name[32];
+    int prio;
+    uint32_t stackSize;
+    ThState_t state;
+    int64_t readySeq;
+    uint64_t wakeUs;
+    int timedOut;
+    void *waitObj;
+    uint64_t busyUs;
+    uint64_t switches;
+    uint64_t sliceStartUs;
+    osThreadFunc_t func;
+    void *arg;
+    struct SimThread *next;
+} SimThread;
+
+typedef struct SimEvent
+{
+    uint64_t atUs;
+    uint64_t seq;
+    SimEventFunc fn;
+    void *arg;
+    struct SimEvent *next;
+} SimEvent;
+
+typedef struct SimMutex
+{
+    SimThread *owner;
+    uint32_t depth;
+    SimMutexStat_t stat;
+    struct SimMutex *next;
+} SimMutex;
+
+typedef struct
+{
+    uint32_t cap;
+    uint32_t msgSize;
+    uint32_t count;
+    uint32_t head;
+    uint8_t *buf;
+} SimQueue;
+
+typedef struct
+{
+    uint32_t flags;
+} SimEventFlags;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max;
+} SimSemaphore;
+
+typedef struct
+{
+    osTimerFunc_t func;
+    void *arg;
+    osTimerType_t type;
+    uint32_t periodTicks;
+    uint32_t generation;
+    int running;
+} SimTimer;
+
+typedef struct
+{
+    const char *name;
+    SimAppEntry entry;
+} SimApp;
+
+static pthread_mutex_t g_lock;
+static SimThread *g_threads = NULL;
+static SimThread *g_cur = NULL;
+static SimEvent *g_events = NULL;
+static SimMutex *g_mutexes = NULL;
+static uint64_t g_now = 0;
+static uint64_t g_eventSeq = 0;
+static int64_t g_readyTail = 1;
+static int64_t g_readyHead = 0;
+static int g_inIsr = 0;
+static void (*g_report)(void) = NULL;
+static struct timespec g_realStart;
+static __thread SimThread *t_self = NULL;
+
+static SimApp g_apps[8];
+static int g_appCount = 0;
+
+/* ============================================================
+ * 调度核心 (调用者必须持有 g_lock)
+ * ============================================================ */
+static uint64_t TickUs(void)
+{
+    return 1000000ULL / g_simCfg.tickHz;
+}
+
+static void Finish(void)
+{
+    if (g_report != NULL)
+        g_report();
+    fflush(stdout);
+    fflush(stderr);
+    exit(0);
+}
+
+static void RealSleepUntil(uint64_t virtUs)
+{
+    if (g_simCfg.speed <= 0)
+        return;
+    double targetS = (double)virtUs / 1e6 / g_simCfg.speed;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsedS = (double)(now.tv_sec - g_realStart.tv_sec) + (double)(now.tv_nsec - g_realStart.tv_nsec) / 1e9;
+    if (targetS > elapsedS)
+    {
+        double d = targetS - elapsedS;
+        struct timespec ts = {(time_t)d, (long)((d - (double)(time_t)d) * 1e9)};
+        nanosleep(&ts, NULL);
+    }
+}
+
+static void MakeReady(SimThread *t, int atHead)
+{
+    t->state = TH_READY;
+    t->waitObj = NULL;
+    t->readySeq = atHead ? g_readyHead-- : g_readyTail++;
+}
+
+static SimThread *PickReady(void)
+{
+    SimThread *best = NULL;
+    for (SimThread *t = g_threads; t != NULL; t = t->next)
+    {
+        if (t->state != TH_READY)
+            continue;
+        if (best == NULL || t->prio > best->prio || (t->prio == best->prio && t->readySeq < best->readySeq))
+            best = t;
+    }
+    return best;
+}
+
+static void WakeObj(void *obj)
+{
+    for (SimThread *t = g_threads; t != NULL; t = t->next)
+    {
+        if (t->state == TH_WAITING && t->waitObj == obj && obj != NULL)
+        {
+            t->timedOut = 0;
+            MakeReady(t, 0);
+        }
+    }
+}
+
+static void FireDue(void)
+{
+    g_inIsr++;
+    while (g_events != NULL && g_events->atUs <= g_now)
+    {
+        SimEvent *ev = g_events;
+        g_events = ev->next;
+        ev->fn(ev->arg);
+        free(ev);
+    }
+    g_inIsr--;
+    for (SimThread *t = g_threads; t != NULL; t = t->next)
+    {
+        if (t->state == TH_WAITING && t->wakeUs <= g_now)
+        {
+            t->timedOut = 1;
+            MakeReady(t, 0);
+        }
+    }
+}
+
+static uint64_t NextDeadline(void)
+{
+    uint64_t t = SIM_FOREVER;
+    if (g_events != NULL)
+        t = g_events->atUs;
+    for (SimThread *th = g_threads; th != NULL; th = th->next)
+    {
+        if (th->state == TH_WAITING && th->wakeUs < t)
+            t = th->wakeUs;
+    }
+    return t;
+}
+
+static void AdvanceTo(uint64_t t)
+{
+    if (t > g_simCfg.durationUs)
+    {
+        g_now = g_simCfg.durationUs;
+        Finish();
+    }
+    RealSleepUntil(t);
+    g_now = t;
+}
+
+/* 当前线程状态已设置好 (READY/WAITING/DONE)，选出下一个运行者并切换 */
+static void Reschedule(SimThread *self)
+{
+    SimThread *next;
+    for (;;)
+    {
+        next = PickReady();
+        if (next != NULL)
+            break;
+        uint64_t t = NextDeadline();
+        if (t == SIM_FOREVER)
+        {
+            fprintf(stderr, "[sim] all threads blocked forever at %.3f s, stopping\n", (double)g_now / 1e6);
+            Finish();
+        }
+        AdvanceTo(t);
+        FireDue();
+    }
+    if (next != self)
+        next->switches++;
+    next->state = TH_RUNNING;
+    next->sliceStartUs = g_now;
+    g_cur = next;
+    if (next != self)
+    {
+        pthread_cond_signal(&next->cv);
+        while (g_cur != self)
+            pthread_cond_wait(&self->cv, &g_lock);
+    }
+}
+
+static int BlockUntil(void *obj, uint64_t wakeUs)
+{
+    SimThread *self = t_self;
+    self->state = TH_WAITING;
+    self->waitObj = obj;
+    self->timedOut = 0;
+    self->wakeUs = wakeUs;
+    Reschedule(self);
+    return self->timedOut;
+}
+
+static void PreemptPoint(void)
+{
+    if (g_inIsr || t_self == NULL || g_cur != t_self)
+        return;
+    SimThread *next = PickReady();
+    if (next != NULL && next->prio > t_self->prio)
+    {
+        MakeReady(t_self, 1);
+        Reschedule(t_self);
+    }
+}
+
+static void Yield(void)
+{
+    SimThread *next = PickReady();
+    if (next != NULL && next->prio >= t_self->prio)
+    {
+        MakeReady(t_self, 0);
+        Reschedule(t_self);
+    }
+}
+
+/* 超时参数 (节拍) 转为绝对唤醒时刻，与 LiteOS 一样在节拍边界唤醒 */
+static uint64_t TimeoutDeadline(uint32_t ticks)
+{
+    if (ticks == osWaitForever)
+        return SIM_FOREVER;
+    return (g_now / TickUs() + ticks) * TickUs();
+}
+
+/* ============================================================
+ * 仿真器接口
+ * ============================================================ */
+uint64_t sim_now_us(void)
+{
+    return g_now;
+}
+
+void sim_busy_us(uint64_t us)
+{
+    pthread_mutex_lock(&g_lock);
+    SimThread *self = t_self;
+    uint64_t remaining = us;
+    while (remaining > 0)
+    {
+        uint64_t step = remaining;
+        uint64_t deadline = NextDeadline();
+        if (deadline > g_now && deadline - g_now < step)
+            step = deadline - g_now;
+        AdvanceTo(g_now + step);
+        remaining -= step;
+        self->busyUs += step;
+        FireDue();
+
+        // 节拍中断：高优先级就绪则抢占，同优先级时间片到期则轮转
+        SimThread *next = PickReady();
+        if (next != NULL && (next->prio > self->prio ||
+                             (next->prio == self->prio && g_now - self->sliceStartUs >= g_simCfg.timesliceUs)))
+        {
+            MakeReady(self, next->prio > self->prio);
+            Reschedule(self);
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+}
+
+void sim_sleep_us(uint64_t us)
+{
+    pthread_mutex_lock(&g_lock);
+    BlockUntil(NULL, g_now + us);
+    pthread_mutex_unlock(&g_lock);
+}
+
+void sim_event_at(uint64_t atUs, SimEventFunc fn, void *arg)
+{
+    pthread_mutex_lock(&g_lock);
+    SimEvent *ev = calloc(1, sizeof(SimEvent));
+    ev->atUs = atUs < g_now ? g_now : atUs;
+    ev->seq = g_eventSeq++;
+    ev->fn = fn;
+    ev->arg = arg;
+    SimEvent **pp = &g_events;
+    while (*pp != NULL && ((*pp)->atUs < ev->atUs || ((*pp)->atUs == ev->atUs && (*pp)->seq < ev->seq)))
+        pp = &(*pp)->next;
+    ev->next = *pp;
+    *pp = ev;
+    pthread_mutex_unlock(&g_lock);
+}
+
+void sim_wake(void *obj)
+{
+    pthread_mutex_lock(&g_lock);
+    WakeObj(obj);
+    PreemptPoint();
+    pthread_mutex_unlock(&g_lock);
+}
+
+void sim_register_app(const char *name, SimAppEntry entry)
+{
+    if (g_appCount < (int)(sizeof(g_apps) / sizeof(g_apps[0])))
+    {
+        g_apps[g_appCount].name = name;
+        g_apps[g_appCount].entry = entry;
+        g_appCount++;
+    }
+}
+
+void sim_run(void (*report)(void))
+{
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&g_lock, &ma);
+    clock_gettime(CLOCK_MONOTONIC, &g_realStart);
+    g_report = report;
+
+    // 主线程扮演系统初始化任务，依次执行 SYS_RUN 注册的应用入口
+    SimThread *mainTh = calloc(1, sizeof(SimThread));
+    pthread_cond_init(&mainTh->cv, NULL);
+    snprintf(mainTh->name, sizeof(mainTh->name), "SysInit");
+    mainTh->prio = osPriorityHigh;
+    mainTh->state = TH_RUNNING;
+    mainTh->pt = pthread_self();
+    t_self = mainTh;
+    g_cur = mainTh;
+    g_threads = mainTh;
+
+    for (int i = 0; i < g_appCount; i++)
+        g_apps[i].entry();
+
+    pthread_mutex_lock(&g_lock);
+    mainTh->state = TH_DONE;
+    Reschedule(mainTh);
+    pthread_mutex_unlock(&g_lock);
+}
+
+int sim_thread_stats(SimThreadStat_t *out, int max)
+{
+    int n = 0;
+    pthread_mutex_lock(&g_lock);
+    for (SimThread *t = g_threads; t != NULL && n < max; t = t->next, n++)
+    {
+        out[n].name = t->name;
+        out[n].priority = t->prio;
+        out[n].stackSize = t->stackSize;
+        out[n].busyUs = t->busyUs;
+        out[n].switches = t->switches;
+    }
+    pthread_mutex_unlock(&g_lock);
+    return n;
+}
+
+int sim_mutex_stats(SimMutexStat_t *out, int max)
+{
+    int n = 0;
+    pthread_mutex_lock(&g_lock);
+    for (SimMutex *m = g_mutexes; m != NULL && n < max; m = m->next, n++)
+        out[n] = m->stat;
+    pthread_mutex_unlock(&g_lock);
+    return n;
+}
+
+/* ============================================================
+ * libc 替换 (见 sim_port.h)
+ * ============================================================ */
+int sim_printf(const char *fmt, ...)
+{
+    static int lineStart = 1;
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (g_simCfg.quiet)
+        return n;
+    for (char *p = buf; *p != '\0'; p++)
+    {
+        if (*p == '\r')
+            continue;
+        if (lineStart)
+        {
+            fprintf(stdout, "[%9.3f] ", (double)g_now / 1e6);
+            lineStart = 0;
+        }
+        fputc(*p, stdout);
+        if (*p == '\n')
+            lineStart = 1;
+    }
+    return n;
+}
+
+int sim_usleep(unsigned int us)
+{
+    uint32_t ticks = (uint32_t)((us + TickUs() - 1) / TickUs());
+    if (ticks == 0)
+        osThreadYield();
+    else
+        osDelay(ticks);
+    return 0;
+}
+
+unsigned int sim_sleep(unsigned int seconds)
+{
+    osDelay(seconds * g_simCfg.tickHz);
+    return 0;
+}
+
+/* ============================================================
+ * hi_time
+ * ============================================================ */
+hi_void hi_udelay(hi_u32 us)
+{
+    sim_busy_us(us);
+}
+
+hi_u32 hi_get_tick(hi_void)
+{
+    return osKernelGetTickCount();
+}
+
+hi_u64 hi_get_tick64(hi_void)
+{
+    return g_now / TickUs();
+}
+
+hi_u32 hi_get_milli_seconds(hi_void)
+{
+    return (hi_u32)(g_now / 1000);
+}
+
+hi_u32 hi_get_seconds(hi_void)
+{
+    return (hi_u32)(g_now / 1000000);
+}
+
+hi_u32 hi_get_us(hi_void)
+{
+    return (hi_u32)g_now;
+}
+
+/* ============================================================
+ * hi_hrtimer：每次 start 递增代数，stop 或重新 start 后旧事件到期时被忽略
+ * ============================================================ */
+#define SIM_HRTIMER_MAX 8
+
+static struct
+{
+    int used;
+    uint32_t gen;
+    hi_hrtimer_callback_f fn;
+    hi_u32 data;
+} g_hrtimers[SIM_HRTIMER_MAX];
+
+static void HrTimer_Fire(void *arg)
+{
+    uintptr_t v = (uintptr_t)arg;
+    uint32_t id = (uint32_t)(v & 0xFF);
+    uint32_t gen = (uint32_t)(v >> 8);
+    if (id >= SIM_HRTIMER_MAX || !g_hrtimers[id].used || g_hrtimers[id].gen != gen || g_hrtimers[id].fn == NULL)
+        return;
+    hi_hrtimer_callback_f fn = g_hrtimers[id].fn;
+    g_hrtimers[id].fn = NULL;
+    fn(g_hrtimers[id].data);
+}
+
+hi_u32 hi_hrtimer_create(hi_u32 *timer_handle)
+{
+    for (uint32_t i = 0; i < SIM_HRTIMER_MAX; i++)
+    {
+        if (!g_hrtimers[i].used)
+        {
+            g_hrtimers[i].used = 1;
+            *timer_handle = i;
+            return HI_ERR_SUCCESS;
+        }
+    }
+    return HI_ERR_FAILURE;
+}
+
+hi_u32 hi_hrtimer_delete(hi_u32 timer_handle)
+{
+    if (timer_handle >= SIM_HRTIMER_MAX)
+        return HI_ERR_FAILURE;
+    g_hrtimers[timer_handle].used = 0;
+    g_hrtimers[timer_handle].gen++;
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_hrtimer_start(hi_u32 timer_handle, hi_u32 expire, hi_hrtimer_callback_f hrtimer_func, hi_u32 data)
+{
+    if (timer_handle >= SIM_HRTIMER_MAX || !g_hrtimers[timer_handle].used || hrtimer_func == NULL)
+        return HI_ERR_FAILURE;
+    uint32_t gen = ++g_hrtimers[timer_handle].gen & 0xFFFFFF;
+    g_hrtimers[timer_handle].gen = gen;
+    g_hrtimers[timer_handle].fn = hrtimer_func;
+    g_hrtimers[timer_handle].data = data;
+    sim_event_at(g_now + expire, HrTimer_Fire, (void *)(((uintptr_t)gen << 8) | timer_handle));
+    return HI_ERR_SUCCESS;
+}
+
+hi_u32 hi_hrtimer_stop(hi_u32 timer_handle)
+{
+    if (timer_handle >= SIM_HRTIMER_MAX)
+        return HI_ERR_FAILURE;
+    g_hrtimers[timer_handle].gen = (g_hrtimers[timer_handle].gen + 1) & 0xFFFFFF;
+    g_hrtimers[timer_handle].fn = NULL;
+    return HI_ERR_SUCCESS;
+}
+
+/* ============================================================
+ * CMSIS-RTOS2: 内核与线程
+ * ============================================================ */
+uint32_t osKernelGetTickCount(void)
+{
+    return (uint32_t)(g_now / TickUs());
+}
+
+uint32_t osKernelGetTickFreq(void)
+{
+    return g_simCfg.tickHz;
+}
+
+uint32_t osKernelGetSysTimerCount(void)
+{
+    return (uint32_t)g_now;
+}
+
+uint32_t osKernelGetSysTimerFreq(void)
+{
+    return 1000000U;
+}
+
+static void *ThreadMain(void *p)
+{
+    SimThread *t = p;
+    t_self = t;
+    pthread_mutex_lock(&g_lock);
+    while (g_cur != t)
+        pthread_cond_wait(&t->cv, &g_lock);
+    pthread_mutex_unlock(&g_lock);
+
+    t->func(t->arg);
+
+    pthread_mutex_lock(&g_lock);
+    t->state = TH_DONE;
+    Reschedule(t);
+    pthread_mutex_unlock(&g_lock);
+    return NULL;
+}
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+    if (func == NULL)
+        return NULL;
+    SimThread *t = calloc(1, sizeof(SimThread));
+    pthread_cond_init(&t->cv, NULL);
+    snprintf(t->name, sizeof(t->name), "%s", (attr != NULL && attr->name != NULL) ? attr->name : "task");
+    t->prio = (attr != NULL && attr->priority != osPriorityNone) ? attr->priority : osPriorityNormal;
+    t->stackSize = (attr != NULL && attr->stack_size != 0) ? attr->stack_size : 2048;
+    t->func = func;
+    t->arg = argument;
+
+    pthread_mutex_lock(&g_lock);
+    SimThread **pp = &g_threads;
+    while (*pp != NULL)
+        pp = &(*pp)->next;
+    *pp = t;
+    MakeReady(t, 0);
+    pthread_create(&t->pt, NULL, ThreadMain, t);
+    PreemptPoint();
+    pthread_mutex_unlock(&g_lock);
+    return t;
+}
+
+osThreadId_t osThreadGetId(void)
+{
+    return t_self;
+}
+
+const char *osThreadGetName(osThreadId_t thread_id)
+{
+    return thread_id != NULL ? ((SimThread *)thread_id)->name : NULL;
+}
+
+osStatus_t osThreadYield(void)
+{
+    pthread_mutex_lock(&g_lock);
+    Yield();
+    pthread_mutex_unlock(&g_lock);
+    return osOK;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    pthread_mutex_lock(&g_lock);
+    if (ticks == 0)
+        Yield();
+    else
+        BlockUntil(NULL, TimeoutDeadline(ticks));
+    pthread_mutex_unlock(&g_lock);
+    return osOK;
+}
+
+osStatus_t osDelayUntil(uint32_t ticks)
+{
+    pthread_mutex_lock(&g_lock);
+    uint64_t at = (uint64_t)ticks * TickUs();
+    if (at > g_now)
+        BlockUntil(NULL, at);
+    pthread_mutex_unlock(&g_lock);
+    return osOK;
+}
+
+/* ============================================================
+ * 软件定时器 (回调在定时事件上下文执行)
+ * ============================================================ */
+typedef struct
+{
+    SimTimer *timer;
+    uint32_t generation;
+} TimerShot;
+
+static void TimerFire(void *arg)
+{
+    TimerShot *shot = arg;
+    SimTimer *tm = shot->timer;
+    if (tm->running && tm->generation == shot->generation)
+    {
+        if (tm->type == osTimerPeriodic)
+        {
+            TimerShot *again = calloc(1, sizeof(TimerShot));
+            *again = *shot;
+            sim_event_at(g_now + (uint64_t)tm->periodTicks * TickUs(), TimerFire, again);
+        }
+        else
+        {
+            tm->running = 0;
+        }
+        tm->func(tm->arg);
+    }
+    free(shot);
+}
+
+osTimerId_t osTimerNew(osTimerFunc_t func, osTimerType_t type, void *argument, const osTimerAttr_t *attr)
+{
+    (void)attr;
+    SimTimer *tm = calloc(1, sizeof(SimTimer));
+    tm->func = func;
+    tm->arg = argument;
+    tm->type = type;
+    return tm;
+}
+
+osStatus_t osTimerStart(osTimerId_t timer_id, uint32_t ticks)
+{
+    SimTimer *tm = timer_id;
+    if (tm == NULL || ticks == 0)
+        return osErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    tm->generation++;
+    tm->running = 1;
+    tm->periodTicks = ticks;
+    TimerShot *shot = calloc(1, sizeof(TimerShot));
+    shot->timer = tm;
+    shot->generation = tm->generation;
+    sim_event_at(TimeoutDeadline(ticks), TimerFire, shot);
+    pthread_mutex_unlock(&g_lock);
+    return osOK;
+}
+
+osStatus_t osTimerStop(osTimerId_t timer_id)
+{
+    SimTimer *tm = timer_id;
+    if (tm == NULL)
+        return osErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    tm->running = 0;
+    tm->generation++;
+    pthread_mutex_unlock(&g_lock);
+    return osOK;
+}
+
+/* ============================================================
+ * 事件标志
+ * ============================================================ */
+osEventFlagsId_t osEventFlagsNew(const osEventFlagsAttr_t *attr)
+{
+    (void)attr;
+    return calloc(1, sizeof(SimEventFlags));
+}
+
+uint32_t osEventFlagsSet(osEventFlagsId_t ef_id, uint32_t flags)
+{
+    SimEventFlags *ef = ef_id;
+    if (ef == NULL)
+        return osFlagsErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    ef->flags |= flags;
+    uint32_t ret = ef->flags;
+    WakeObj(ef);
+    PreemptPoint();
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
+uint32_t osEventFlagsClear(osEventFlagsId_t ef_id, uint32_t flags)
+{
+    SimEventFlags *ef = ef_id;
+    if (ef == NULL)
+        return osFlagsErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    uint32_t ret = ef->flags;
+    ef->flags &= ~flags;
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
+uint32_t osEventFlagsGet(osEventFlagsId_t ef_id)
+{
+    SimEventFlags *ef = ef_id;
+    return ef != NULL ? ef->flags : 0;
+}
+
+uint32_t osEventFlagsWait(osEventFlagsId_t ef_id, uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    SimEventFlags *ef = ef_id;
+    if (ef == NULL || flags == 0)
+        return osFlagsErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    uint64_t deadline = TimeoutDeadline(timeout);
+    uint32_t ret;
+    for (;;)
+    {
+        uint32_t hit = ef->flags & flags;
+        int ok = (options & osFlagsWaitAll) ? (hit == flags) : (hit != 0);
+        if (ok)
+        {
+            ret = ef->flags;
+            if (!(options & osFlagsNoClear))
+                ef->flags &= ~flags;
+            break;
+        }
+        if (timeout == 0)
+        {
+            ret = osFlagsErrorResource;
+            break;
+        }
+        if (BlockUntil(ef, deadline))
+        {
+            ret = osFlagsErrorTimeout;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
+/* ============================================================
+ * 互斥锁 (LiteOS 互斥锁可递归；记录争用与等待时间)
+ * ============================================================ */
+osMutexId_t osMutexNew(const osMutexAttr_t *attr)
+{
+    (void)attr;
+    SimMutex *m = calloc(1, sizeof(SimMutex));
+    pthread_mutex_lock(&g_lock);
+    m->stat.owner = t_self != NULL ? t_self->name : "?";
+    SimMutex **pp = &g_mutexes;
+    while (*pp != NULL)
+        pp = &(*pp)->next;
+    *pp = m;
+    pthread_mutex_unlock(&g_lock);
+    return m;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    SimMutex *m = mutex_id;
+    if (m == NULL)
+        return osErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    osStatus_t ret = osOK;
+    m->stat.acquires++;
+    if (m->owner != NULL && m->owner != t_self)
+    {
+        if (timeout == 0)
+        {
+            ret = osErrorResource;
+        }
+        else
+        {
+            uint64_t t0 = g_now;
+            uint64_t deadline = TimeoutDeadline(timeout);
+            m->stat.contentions++;
+            while (m->owner != NULL)
+            {
+                if (BlockUntil(m, deadline))
+                {
+                    ret = osErrorTimeout;
+                    break;
+                }
+            }
+            uint64_t waited = g_now - t0;
+            m->stat.waitUs += waited;
+            if (waited > m->stat.maxWaitUs)
+                m->stat.maxWaitUs = waited;
+        }
+    }
+    if (ret == osOK)
+    {
+        m->owner = t_self;
+        m->depth++;
+    }
+    int hold = (ret == osOK && m->depth == 1 && g_simCfg.lockHoldUs > 0 && g_inIsr == 0);
+    pthread_mutex_unlock(&g_lock);
+    // 固件代码本身不耗虚拟时间，临界区内没有抢占点；按场景给每次持锁加上 CPU 时间
+    if (hold)
+        sim_busy_us(g_simCfg.lockHoldUs);
+    return ret;
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    SimMutex *m = mutex_id;
+    if (m == NULL)
+        return osErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    osStatus_t ret = osOK;
+    if (m->owner != t_self)
+    {
+        ret = osErrorResource;
+    }
+    else if (--m->depth == 0)
+    {
+        m->owner = NULL;
+        WakeObj(m);
+        PreemptPoint();
+    }
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
+/* ============================================================
+ * 信号量
+ * ============================================================ */
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr)
+{
+    (void)attr;
+    SimSemaphore *s = calloc(1, sizeof(SimSemaphore));
+    s->max = max_count;
+    s->count = initial_count;
+    return s;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+    SimSemaphore *s = semaphore_id;
+    if (s == NULL)
+        return osErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    osStatus_t ret = osOK;
+    uint64_t deadline = TimeoutDeadline(timeout);
+    while (s->count == 0)
+    {
+        if (timeout == 0)
+        {
+            ret = osErrorResource;
+            break;
+        }
+        if (BlockUntil(s, deadline))
+        {
+            ret = osErrorTimeout;
+            break;
+        }
+    }
+    if (ret == osOK)
+        s->count--;
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+    SimSemaphore *s = semaphore_id;
+    if (s == NULL)
+        return osErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    osStatus_t ret = osOK;
+    if (s->count >= s->max)
+    {
+        ret = osErrorResource;
+    }
+    else
+    {
+        s->count++;
+        WakeObj(s);
+        PreemptPoint();
+    }
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
+/* ============================================================
+ * 消息队列
+ * ============================================================ */
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr)
+{
+    (void)attr;
+    if (msg_count == 0 || msg_size == 0)
+        return NULL;
+    SimQueue *q = calloc(1, sizeof(SimQueue));
+    q->cap = msg_count;
+    q->msgSize = msg_size;
+    q->buf = calloc(msg_count, msg_size);
+    return q;
+}
+
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout)
+{
+    (void)msg_prio;
+    SimQueue *q = mq_id;
+    if (q == NULL || msg_ptr == NULL)
+        return osErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    osStatus_t ret = osOK;
+    uint64_t deadline = TimeoutDeadline(timeout);
+    while (q->count == q->cap)
+    {
+        if (timeout == 0)
+        {
+            ret = osErrorResource;
+            break;
+        }
+        if (BlockUntil(q, deadline))
+        {
+            ret = osErrorTimeout;
+            break;
+        }
+    }
+    if (ret == osOK)
+    {
+        memcpy(q->buf + ((q->head + q->count) % q->cap) * q->msgSize, msg_ptr, q->msgSize);
+        q->count++;
+        WakeObj(q);
+        PreemptPoint();
+    }
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout)
+{
+    SimQueue *q = mq_id;
+    if (q == NULL || msg_ptr == NULL)
+        return osErrorParameter;
+    pthread_mutex_lock(&g_lock);
+    osStatus_t ret = osOK;
+    uint64_t deadline = TimeoutDeadline(timeout);
+    while (q->count == 0)
+    {
+        if (timeout == 0)
+        {
+            ret = osErrorResource;
+            break;
+        }
+        if (BlockUntil(q, deadline))
+        {
+            ret = osErrorTimeout;
+            break;
+        }
+    }
+    if (ret == osOK)
+    {
+        memcpy(msg_ptr, q->buf + q->head * q->msgSize, q->msgSize);
+        q->head = (q->head + 1) % q->cap;
+        q->count--;
+        if (msg_prio != NULL)
+            *msg_prio = 0;
+        WakeObj(q);
+        PreemptPoint();
+    }
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id)
+{
+    SimQueue *q = mq_id;
+    return q != NULL ? q->count : 0;
+}
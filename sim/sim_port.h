@@ -0,0 +1,19 @@
+/*
+ * 固件源文件的强制包含头 (-include sim_port.h)
+ * 把 libc 的 usleep/sleep/printf 换成虚拟时钟版本，固件源码本身不做任何修改
+ */
+#ifndef SIM_PORT_H
+#define SIM_PORT_H
+
+#include <stdio.h>
+#include <unistd.h>
+
+int sim_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+int sim_usleep(unsigned int us);
+unsigned int sim_sleep(unsigned int seconds);
+
+#define printf sim_printf
+#define usleep sim_usleep
+#define sleep sim_sleep
+
+#endif
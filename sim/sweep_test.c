@@ -0,0 +1,348 @@
+/*
+ * 二进制整帧上报编解码往返测试 (主机)
+ *
+ * 直接包含 ../ultrasonic_radar.c 取得固件的 Sweep_Encode()，用构造的帧覆盖距离块的各条编码路径，
+ * 交给 host/sweep_decoder 解码后逐项比对；再检查截断、多余字节和差分基准不符时解码器的返回值。
+ * 不启动内核。以 -DRADAR_ANGLE_RES_DEG=1 编译 (181 个角度)，才能走到 64 个角度一段的拆分。
+ * 另外检查 JSON 格式 (Sweep_Format) 在最长的帧下放得进 MQTT_SWEEP_PAYLOAD，缓冲不足时截断而不越界。
+ *
+ * 用法: make test
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+
+#include "../ultrasonic_radar.c"
+#include "../host/sweep_decoder.h"
+
+static int g_checks = 0, g_failed = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        g_checks++;                                                                                                    \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            g_failed++;                                                                                                \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__);                                                       \
+            fprintf(stderr, __VA_ARGS__);                                                                              \
+            fprintf(stderr, "\n");                                                                                     \
+        }                                                                                                              \
+    } while (0)
+
+// 距离块里各类操作的个数与最长一段
+typedef struct
+{
+    int ops[4];
+    int runMax[4];
+} TestOps_t;
+
+static RadarState_t g_testState = {.sysState = SYSTEM_SCANNING};
+static uint8_t g_testBuf[MQTT_SWEEP_PAYLOAD];
+
+/* 按 seq 生成一帧：距离由调用者填，其余字段取有代表性的值 */
+static void Test_InitFrame(RadarFrame_t *f, uint32_t seq)
+{
+    memset(f, 0, sizeof(*f));
+    f->seq = seq;
+    f->startMs = 100000 + seq * 1500;
+    f->endMs = f->startMs + 1480;
+    f->direction = (seq & 1) ? 1 : -1;
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+    {
+        // 从未测到 / 刚测到 / 超过上限三种测距时刻都出现
+        if (i % 7 == 3)
+            f->stampMs[i] = 0;
+        else if (i % 7 == 5)
+            f->stampMs[i] = 1; // endMs - 1 远超 SWEEP_AGE_MAX 个单位
+        else
+            f->stampMs[i] = f->endMs - (uint32_t)(i * SWEEP_AGE_UNIT_MS);
+        if (i % 11 == 0)
+        {
+            f->fgMask[i / 8] |= (uint8_t)(1u << (i % 8));
+            f->fgCount++;
+        }
+    }
+    f->objectCount = 3;
+    for (int i = 0; i < f->objectCount; i++)
+    {
+        RadarObject_t *o = &f->objects[i];
+        o->id = (uint8_t)(i + 1);
+        o->bearing = (uint8_t)(30 + 60 * i);
+        o->rangeMm = (uint16_t)(400 + 1000 * i);
+        o->velMmS = (int16_t)(i == 0 ? -350 : 120 * i);
+        o->ttcMs = i == 0 ? 1142 : SWEEP_TTC_NONE;
+    }
+}
+
+static void Test_ScanOps(const uint8_t *buf, int len, TestOps_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    int pos = SWEEP_HDR_SIZE + (RADAR_FRAME_BINS + 7) / 8;
+    int bins = 0;
+    while (bins < RADAR_FRAME_BINS && pos < len)
+    {
+        uint8_t op = buf[pos++];
+        int kind = (op & SWEEP_OP_MASK) >> 6;
+        int run = (op & ~SWEEP_OP_MASK) + 1;
+        out->ops[kind]++;
+        if (run > out->runMax[kind])
+            out->runMax[kind] = run;
+        bins += run;
+        pos += kind == 1 ? run : kind == 2 ? run * 2 : 0;
+    }
+}
+
+/* 解码结果与原帧逐项比对 */
+static void Test_Compare(const SweepDecoded_t *d, const RadarFrame_t *f, const char *name)
+{
+    CHECK(d->bins == RADAR_FRAME_BINS, "%s: bins %u", name, d->bins);
+    CHECK(d->seq == f->seq && d->endMs == f->endMs && d->spanMs == f->endMs - f->startMs, "%s: header", name);
+    CHECK(d->dir == f->direction && d->a0 == SCAN_START_ANGLE && d->da == RADAR_ANGLE_RES_DEG, "%s: geometry", name);
+    CHECK(d->state == SYSTEM_SCANNING && d->fgCount == f->fgCount, "%s: state/fg", name);
+    CHECK(memcmp(d->fgMask, f->fgMask, sizeof(f->fgMask)) == 0, "%s: fg mask", name);
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+    {
+        CHECK(d->rangeMm[i] == f->rangeMm[i], "%s: bin %d range %u != %u", name, i, d->rangeMm[i], f->rangeMm[i]);
+        int32_t age = f->stampMs[i] ? (int32_t)(f->endMs - f->stampMs[i]) : -1;
+        if (age < 0)
+            CHECK(d->ageMs[i] == -1, "%s: bin %d age %d, expected none", name, i, (int)d->ageMs[i]);
+        else if (age >= SWEEP_AGE_MAX * SWEEP_AGE_UNIT_MS)
+            CHECK(d->ageMs[i] == SWEEP_AGE_MAX * SWEEP_AGE_UNIT_MS, "%s: bin %d age not clamped", name, i);
+        else
+            CHECK(abs(d->ageMs[i] - age) <= SWEEP_AGE_UNIT_MS / 2, "%s: bin %d age %d vs %d", name, i,
+                  (int)d->ageMs[i], (int)age);
+    }
+    CHECK(d->objectCount == f->objectCount, "%s: objects %u", name, d->objectCount);
+    for (int i = 0; i < f->objectCount && i < d->objectCount; i++)
+    {
+        const RadarObject_t *o = &f->objects[i];
+        const SweepObject_t *p = &d->objects[i];
+        CHECK(p->id == o->id && p->bearing == o->bearing && p->rangeMm == o->rangeMm && p->velMmS == o->velMmS &&
+                  p->ttcMs == o->ttcMs,
+              "%s: object %d", name, i);
+    }
+}
+
+/* 编码 (base 为 NULL 即关键帧) → 解码 → 比对，返回编码长度 */
+static int Test_RoundTrip(SweepDecoder_t *dec, const RadarFrame_t *f, const RadarFrame_t *base, const char *name,
+                          TestOps_t *ops)
+{
+    int len = Sweep_Encode(f, &g_testState, base ? base->rangeMm : NULL, base ? base->seq : 0, g_testBuf);
+    CHECK(len > 0 && len <= MQTT_SWEEP_PAYLOAD, "%s: encoded %d bytes", name, len);
+    Test_ScanOps(g_testBuf, len, ops);
+    static SweepDecoded_t d;
+    SweepResult_t ret = SweepDecoder_Feed(dec, g_testBuf, (size_t)len, &d);
+    CHECK(ret == SWEEP_OK, "%s: decode returned %d", name, ret);
+    if (ret == SWEEP_OK)
+    {
+        CHECK(d.key == (base == NULL), "%s: key flag", name);
+        Test_Compare(&d, f, name);
+    }
+    return len;
+}
+
+/* 关键帧：绝对值段 (含超过 64 个角度的拆分)、相对 0 的小差分段与省略段都出现 */
+static void Test_Keyframe(SweepDecoder_t *dec, RadarFrame_t *key)
+{
+    TestOps_t ops;
+    Test_InitFrame(key, 1);
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+        key->rangeMm[i] = (uint16_t)(1000 + 13 * i);
+    for (int i = 100; i < 110; i++)
+        key->rangeMm[i] = 0; // 无目标：相对全零基准相同
+    key->rangeMm[120] = 127; // 相对 0 的差分恰好在 int8 内
+    key->rangeMm[121] = 128;
+    key->rangeMm[RADAR_FRAME_BINS - 1] = RADAR_MAX_RANGE_MM;
+    Test_RoundTrip(dec, key, NULL, "keyframe", &ops);
+    CHECK(ops.ops[SWEEP_OP_ABS16 >> 6] >= 2 && ops.runMax[SWEEP_OP_ABS16 >> 6] == SWEEP_OP_RUN_MAX,
+          "keyframe: ABS16 runs %d, longest %d", ops.ops[2], ops.runMax[2]);
+    CHECK(ops.ops[SWEEP_OP_SAME >> 6] >= 1, "keyframe: no SAME run for empty bins");
+    CHECK(ops.ops[SWEEP_OP_DELTA8 >> 6] >= 1, "keyframe: no DELTA8 run for 127 mm");
+}
+
+/* 与基准完全相同：省略段按 64 个角度拆开 */
+static void Test_SameRuns(SweepDecoder_t *dec, const RadarFrame_t *base, RadarFrame_t *f)
+{
+    TestOps_t ops;
+    Test_InitFrame(f, base->seq + 1);
+    memcpy(f->rangeMm, base->rangeMm, sizeof(f->rangeMm));
+    int len = Test_RoundTrip(dec, f, base, "unchanged", &ops);
+    int expected = (RADAR_FRAME_BINS + SWEEP_OP_RUN_MAX - 1) / SWEEP_OP_RUN_MAX;
+    CHECK(ops.ops[0] == expected && ops.ops[1] == 0 && ops.ops[2] == 0, "unchanged: %d SAME runs, expected %d",
+          ops.ops[0], expected);
+    CHECK(len == SWEEP_HDR_SIZE + (RADAR_FRAME_BINS + 7) / 8 + expected + RADAR_FRAME_BINS +
+                     f->objectCount * SWEEP_OBJ_SIZE,
+          "unchanged: %d bytes", len);
+}
+
+/* 每个角度都有小变化：差分段按 64 个角度拆开 */
+static void Test_DeltaRuns(SweepDecoder_t *dec, const RadarFrame_t *base, RadarFrame_t *f)
+{
+    TestOps_t ops;
+    Test_InitFrame(f, base->seq + 1);
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+        f->rangeMm[i] = (uint16_t)(base->rangeMm[i] + 1 + i % 3);
+    Test_RoundTrip(dec, f, base, "small deltas", &ops);
+    CHECK(ops.ops[1] == (RADAR_FRAME_BINS + SWEEP_OP_RUN_MAX - 1) / SWEEP_OP_RUN_MAX &&
+              ops.runMax[1] == SWEEP_OP_RUN_MAX && ops.ops[0] == 0 && ops.ops[2] == 0,
+          "small deltas: %d DELTA8 runs, longest %d", ops.ops[1], ops.runMax[1]);
+}
+
+/* int8 边界：+127/-128 走 1 字节差分，+128/-129 必须改走绝对值 */
+static void Test_DeltaBounds(SweepDecoder_t *dec, const RadarFrame_t *base, RadarFrame_t *f)
+{
+    static const int32_t deltas[] = {127, -128, 128, -129, 127, 127, -128, -129, 128, 1, -1, 0, 0, 0};
+    const int n = (int)(sizeof(deltas) / sizeof(deltas[0]));
+    TestOps_t ops;
+    Test_InitFrame(f, base->seq + 1);
+    memcpy(f->rangeMm, base->rangeMm, sizeof(f->rangeMm));
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+    {
+        int32_t v = (int32_t)base->rangeMm[i] + deltas[i % n];
+        f->rangeMm[i] = (uint16_t)(v < 0 ? base->rangeMm[i] : v);
+    }
+    Test_RoundTrip(dec, f, base, "int8 bounds", &ops);
+    CHECK(ops.ops[1] > 0 && ops.ops[2] > 0, "int8 bounds: DELTA8 %d, ABS16 %d", ops.ops[1], ops.ops[2]);
+
+    // 单独一个 -128 / +128 的角度
+    RadarFrame_t g;
+    Test_InitFrame(&g, f->seq + 1);
+    memcpy(g.rangeMm, f->rangeMm, sizeof(g.rangeMm));
+    g.rangeMm[40] = (uint16_t)(f->rangeMm[40] - 128);
+    g.rangeMm[80] = (uint16_t)(f->rangeMm[80] + 128);
+    Test_RoundTrip(dec, &g, f, "single -128/+128", &ops);
+    CHECK(ops.ops[1] == 1 && ops.ops[2] == 1, "single -128/+128: DELTA8 %d, ABS16 %d", ops.ops[1], ops.ops[2]);
+    memcpy(f, &g, sizeof(g));
+}
+
+/* 截断或多出字节的消息必须报格式错误，且不能改动解码器的基准 */
+static void Test_Truncated(SweepDecoder_t *dec, const RadarFrame_t *base, RadarFrame_t *f)
+{
+    Test_InitFrame(f, base->seq + 1);
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+        f->rangeMm[i] = (uint16_t)(base->rangeMm[i] + (i % 5 == 0 ? 300 : i % 5 == 1 ? -2 : 0));
+    int len = Sweep_Encode(f, &g_testState, base->rangeMm, base->seq, g_testBuf);
+    static SweepDecoded_t d;
+    for (int n = 0; n < len; n++)
+    {
+        SweepDecoder_t probe = *dec;
+        SweepResult_t ret = SweepDecoder_Feed(&probe, g_testBuf, (size_t)n, &d);
+        CHECK(ret == SWEEP_ERR_FORMAT, "truncated to %d of %d bytes: returned %d", n, len, ret);
+        CHECK(memcmp(&probe, dec, sizeof(probe)) == 0, "truncated to %d bytes: decoder base changed", n);
+    }
+    g_testBuf[len] = 0;
+    SweepDecoder_t probe = *dec;
+    CHECK(SweepDecoder_Feed(&probe, g_testBuf, (size_t)len + 1, &d) == SWEEP_ERR_FORMAT, "trailing byte accepted");
+
+    uint8_t bad[SWEEP_HDR_SIZE];
+    memcpy(bad, g_testBuf, sizeof(bad));
+    bad[1] = SWEEP_VERSION + 1;
+    CHECK(SweepDecoder_Feed(&probe, bad, sizeof(bad), &d) == SWEEP_ERR_FORMAT, "unknown version accepted");
+
+    CHECK(SweepDecoder_Feed(dec, g_testBuf, (size_t)len, &d) == SWEEP_OK, "full message after truncations failed");
+    Test_Compare(&d, f, "after truncations");
+}
+
+/* 差分基准不符：漏收一条、刚开始订阅都返回 SWEEP_ERR_BASE，下一个关键帧恢复 */
+static void Test_BaseMismatch(SweepDecoder_t *dec, const RadarFrame_t *base)
+{
+    static RadarFrame_t lost, next, key;
+    static SweepDecoded_t d;
+    TestOps_t ops;
+
+    Test_InitFrame(&lost, base->seq + 1);
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+        lost.rangeMm[i] = (uint16_t)(base->rangeMm[i] + 5);
+    Test_InitFrame(&next, base->seq + 2);
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+        next.rangeMm[i] = (uint16_t)(lost.rangeMm[i] + 5);
+
+    // lost 没送到：next 以 lost 为基准
+    int len = Sweep_Encode(&next, &g_testState, lost.rangeMm, lost.seq, g_testBuf);
+    SweepDecoder_t before = *dec;
+    CHECK(SweepDecoder_Feed(dec, g_testBuf, (size_t)len, &d) == SWEEP_ERR_BASE, "missing base not detected");
+    CHECK(memcmp(&before, dec, sizeof(before)) == 0, "failed decode changed the base");
+
+    SweepDecoder_t fresh;
+    SweepDecoder_Init(&fresh);
+    CHECK(SweepDecoder_Feed(&fresh, g_testBuf, (size_t)len, &d) == SWEEP_ERR_BASE, "delta without any base accepted");
+
+    Test_InitFrame(&key, next.seq + 1);
+    memcpy(key.rangeMm, next.rangeMm, sizeof(key.rangeMm));
+    Test_RoundTrip(&fresh, &key, NULL, "recovery keyframe", &ops);
+    Test_RoundTrip(dec, &key, NULL, "recovery keyframe (old decoder)", &ops);
+}
+
+/* JSON：按 MQTT_SWEEP_PAYLOAD 预算内最长的帧不截断；缓冲给小了截断成合法结尾且不写出界 */
+static void Test_Json(void)
+{
+    static RadarFrame_t f;
+    static char json[MQTT_SWEEP_PAYLOAD + 64];
+    Test_InitFrame(&f, 7);
+    f.endMs = 9999999 + 1; // 测距时刻取到预算内的 7 位毫秒数
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+    {
+        f.rangeMm[i] = 65535;
+        f.stampMs[i] = 1;
+    }
+    f.objectCount = TRACK_MAX;
+    for (int i = 0; i < TRACK_MAX; i++)
+    {
+        RadarObject_t *o = &f.objects[i];
+        o->id = 255;
+        o->bearing = SCAN_END_ANGLE;
+        o->rangeMm = 65535;
+        o->velMmS = -32768;
+        o->ttcMs = 65534;
+    }
+    RadarState_t st = {.sysState = SYSTEM_SCANNING, .angle = SCAN_END_ANGLE, .rangeMm = 65535};
+
+    uint32_t truncated = g_sweepPubStats.truncated;
+    int len = Sweep_Format(&f, &st, json, MQTT_SWEEP_PAYLOAD);
+    CHECK(g_sweepPubStats.truncated == truncated, "json: longest frame truncated (%d bytes of %d)", len,
+          MQTT_SWEEP_PAYLOAD);
+    CHECK(len > 0 && len < MQTT_SWEEP_PAYLOAD && (int)strlen(json) == len, "json: %d bytes", len);
+    CHECK(len >= 2 && strcmp(json + len - 2, "]}") == 0, "json: bad ending");
+    int commas = 0;
+    const char *r = strstr(json, "\"r\":[");
+    for (const char *c = r; c && *c != ']'; c++)
+        commas += (*c == ',');
+    CHECK(r && commas == RADAR_FRAME_BINS - 1, "json: %d ranges", commas + 1);
+
+    // 缓冲不足：各处截断，尾部哨兵不能被改动
+    for (int size = 64; size < len; size += 37)
+    {
+        memset(json, 0xA5, sizeof(json));
+        truncated = g_sweepPubStats.truncated;
+        int n = Sweep_Format(&f, &st, json, size);
+        CHECK(g_sweepPubStats.truncated == truncated + 1, "json size %d: truncation not counted", size);
+        CHECK(n < size && (int)strlen(json) == n, "json size %d: returned %d", size, n);
+        CHECK(n == 0 || strcmp(json + n - 2, "]}") == 0, "json size %d: bad ending", size);
+        int intact = 1;
+        for (int i = size; i < (int)sizeof(json); i++)
+            intact &= ((uint8_t)json[i] == 0xA5);
+        CHECK(intact, "json size %d: wrote past the buffer", size);
+    }
+}
+
+int main(void)
+{
+    static RadarFrame_t key, f1, f2, f3, f4;
+    SweepDecoder_t dec;
+    SweepDecoder_Init(&dec);
+
+    CHECK(RADAR_FRAME_BINS > 2 * SWEEP_OP_RUN_MAX, "need more than %d bins to split runs (have %d)",
+          2 * SWEEP_OP_RUN_MAX, RADAR_FRAME_BINS);
+    Test_Keyframe(&dec, &key);
+    Test_SameRuns(&dec, &key, &f1);
+    Test_DeltaRuns(&dec, &f1, &f2);
+    Test_DeltaBounds(&dec, &f2, &f3);
+    Test_Truncated(&dec, &f3, &f4);
+    Test_BaseMismatch(&dec, &f4);
+    Test_Json();
+
+    printf("sweep_test: %d checks, %d failed (%d bins)\n", g_checks, g_failed, RADAR_FRAME_BINS);
+    return g_failed ? 1 : 0;
+}
@@ -2,6 +2,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 
 #include "ohos_init.h"
 #include "cmsis_os2.h"
@@ -10,6 +11,8 @@
 #include "hi_gpio.h"
 #include "hi_io.h"
 #include "hi_pwm.h"
+#include "hi_time.h"
+#include "hi_hrtimer.h"
 #include "hi_wifi_api.h"
 
 // BSP 头文件
@@ -19,13 +22,17 @@
 #include "bsp_sg90.h"
 #include "bsp_oled.h"
 #include "bsp_beep.h"
-#include "bsp_wifi.h"
-#include "bsp_mqtt.h"
 
 // 网络协议栈
 #include "lwip/sockets.h"
 #include "lwip/netifapi.h"
 
+// 扫描帧二进制上报格式 (与主机解码库共用)
+#include "radar_sweep.h"
+// 网络服务：WiFi/MQTT 会话、主题路由、事件驱动接收与非阻塞发布队列 (与各实验共用)
+#include "net_service.h"
+#include "mqtt_pubq.h"
+
 /* ============================================================
  * 用户配置区域
  * ============================================================ */
@@ -42,6 +49,13 @@
 // 3. MQTT 主题定义
 #define MQTT_TOPIC_CONTROL "hi3861/radar/control" // 订阅
 #define MQTT_TOPIC_DATA "hi3861/radar/data"       // 发布
+#define MQTT_SWEEP_MIN_INTERVAL_MS 500 // 整帧上报的最小间隔 (限速，0 为不限)，可用控制指令 RATE:<ms> 修改
+// 整帧上报缓冲，随角度数变化：JSON 头 + 每个角度的距离 (6 字符) 与测距时刻 (8 字符) + 目标列表；
+// 个别角度超过 7 位毫秒数 (约 2.8 小时未刷新) 而放不下时由 Sweep_Format 截断
+#define MQTT_SWEEP_PAYLOAD (256 + RADAR_FRAME_BINS * 14 + TRACK_MAX * 32)
+#define MQTT_SWEEP_DEFAULT_FORMAT SWEEP_FORMAT_BINARY // 控制指令 FORMAT:JSON 切回 JSON (兼容现有 HTML 端)
+#define MQTT_SWEEP_KEY_EVERY 10        // 二进制格式每隔多少条上报发一个关键帧 (漏收差分帧后由此恢复)
+#define MQTT_PUB_DROP_POLICY MQTT_PUBQ_DROP_OLDEST // 上行带宽不够时发布队列丢最旧的帧 (上报只关心最新一帧)
 
 // 4. 雷达参数配置
 #define SCAN_START_ANGLE 0
@@ -49,6 +63,158 @@
 #define SCAN_STEP_ANGLE 5
 #define WARNING_DISTANCE_CM 30
 #define ALARM_DISTANCE_CM 10
+#define WARNING_DISTANCE_MM (WARNING_DISTANCE_CM * 10) // 测距流水线内部一律用整数毫米
+#define ALARM_DISTANCE_MM (ALARM_DISTANCE_CM * 10)
+
+// 5. 测距流水线配置
+#define SR04_GAP_MARGIN_US 2000 // 回波窗口之外两次触发间额外留出的余振衰减时间
+#define RANGING_DEFAULT_MODE RANGING_PIPELINED
+
+// 6. 角度分区滤波配置 (每个扫描角度一个独立滤波器)
+#define RADAR_BIN_COUNT ((SCAN_END_ANGLE - SCAN_START_ANGLE) / SCAN_STEP_ANGLE + 1)
+#define FILTER_DEFAULT_MODE FILTER_MEDIAN
+#define FILTER_MEDIAN_N 3    // 中值窗口长度 (奇数, 不超过 7)
+#define FILTER_ALPHA_Q16 32768 // α-β 滤波位置增益 0.5 (Q16 定点，芯片无浮点单元)
+#define FILTER_BETA_Q16 6554   // α-β 滤波速度增益 0.1 (Q16)
+#define FILTER_GATE_MM 500   // α-β 残差门限 (原突变抑制)
+#define FILTER_REJECT_LIMIT 3 // 连续超门限次数达到后认为目标确实变化，重新初始化
+#define FILTER_MISS_LIMIT 2  // 连续无回波次数达到后清空该角度
+
+// 7. 扫描帧配置 (一帧 = 一次完整扫描的极坐标数据)
+#ifndef RADAR_ANGLE_RES_DEG
+#define RADAR_ANGLE_RES_DEG SCAN_STEP_ANGLE // 帧角度分辨率，可小于扫描步进
+#endif
+#define RADAR_FRAME_BINS ((SCAN_END_ANGLE - SCAN_START_ANGLE) / RADAR_ANGLE_RES_DEG + 1)
+#define RADAR_MAX_RANGE_MM 4000             // SR04 量程上限
+#define DISPLAY_RANGE_CM 100                // OLED 雷达图满量程
+
+// 8. 扫描帧池配置 (帧只写一次，按指针分发给各消费者)
+#define FRAME_MAILBOX_DEPTH 1 // 每个消费者最多积压的帧数，满时丢弃最旧的一帧
+#define FRAME_POOL_SIZE (FRAME_CONSUMER_COUNT * (FRAME_MAILBOX_DEPTH + 1) + 2) // 各消费者积压+在用，外加后台帧与最新帧
+#define FRAME_LOG_EVERY 10    // 日志消费者每隔多少帧打印一次分发统计
+
+// 9. 异步测距配置 (回波边沿由 GPIO 中断打时间戳)
+#define SR04_ECHO_TIMEOUT_MS 40 // 触发后等待回波结束的上限 (模块无回波时自身输出约 38ms 脉宽)
+#define SR04_BURST_US 500       // 触发到回波上升沿之间的发射时间
+#define SR04_ECHO_US(cm) ((uint32_t)(cm) * 1000 / 17) // 距离对应的回波脉宽 (0.017 cm/us)
+#define SR04_US_TO_MM(us) (((uint32_t)(us) * 17 + 50) / 100) // 回波脉宽对应的距离 (0.17 mm/us，四舍五入)
+#define SR04_EVT_DONE 0x00000001U
+#define SR04_EVT_GATE 0x00000002U // 距离门到期仍未收到回波
+
+// 10. 距离门配置 (只听门内回波，缩短等待与触发间隔)
+#define RANGE_GATE_NEAR_CM 50    // 近场快速门，覆盖告警与警告距离
+#define RANGE_GATE_SURVEY_CM 400 // 全量程巡视
+#define RANGE_GATE_DEFAULT GATE_SURVEY
+
+// 11. 舵机运动模型 (稳定时间 = 基础时延 + 转角 × 每度转动时间，可在线标定)
+#define SERVO_MODEL_BASE_US 12000    // 默认基础时延：指令在下一个 PWM 帧生效 + 余振
+#define SERVO_MODEL_PER_DEG_US 1700  // 默认转速：SG90 标称 0.1s/60°
+#define SERVO_SETTLE_MARGIN_US 8000  // 标定结果额外留出的余振时间 (测距分辨不出)
+#define SERVO_CAL_REF_ANGLE 90       // 标定参考角度，正前方近场门内需放一个孤立目标
+#define SERVO_CAL_TOL_CM 3           // 读数与参考距离相差在此范围内视为对准目标
+#define SERVO_CAL_REPEAT 3           // 每个转角重复次数，取最坏值
+#define SERVO_CAL_TIMEOUT_MS 1000    // 单次转动等待读数变化的上限
+
+// 12. 扫描策略 (逐步停稳测距 / 连续转动定时测距 / 按扇区兴趣度自适应)
+#define SCAN_DEFAULT_STRATEGY SCAN_STEP
+#define CONT_SWEEP_DEG_PER_S 300  // 连续扫描角速度
+#define CONT_PING_INTERVAL_MS 30  // 连续扫描测距节拍 (系统节拍的整数倍)
+#define CONT_SERVO_TICKS 1        // 连续扫描舵机指令刷新周期 (系统节拍)，小于 PWM 帧周期以保证每帧都有新目标
+#define CONT_TRACK_LAG_US 32000   // 舵机实际位置落后于指令轨迹的平均时间 (定时器节拍 + PWM 帧等待 + 转动)
+
+// 13. 自适应扫描 (扇区兴趣度 0~100，检测到目标/告警时升高，每次访问衰减)
+#define ADAPT_SECTOR_DEG 30
+#define ADAPT_SECTOR_COUNT ((SCAN_END_ANGLE - SCAN_START_ANGLE) / ADAPT_SECTOR_DEG)
+#define ADAPT_FINE_STEP SCAN_STEP_ANGLE // 有目标扇区的细扫步进
+#define ADAPT_COARSE_STEP 15            // 空扇区的粗扫步进 (每扇区两次测距，靠波束宽度覆盖)
+#define ADAPT_MAX_REVISIT_MS 3000       // 任一扇区两次访问的最长间隔
+#define ADAPT_DUE_MARGIN_MS 800         // 距最长间隔不足此时间的扇区优先访问 (约三次细扫的时间)
+#define ADAPT_TARGET_CM DISPLAY_RANGE_CM // 此距离内的回波视为扇区内有目标
+#define ADAPT_INTEREST_HIT 40           // 本次访问有目标
+#define ADAPT_INTEREST_ALARM 60         // 本次访问有目标进入警告距离
+#define ADAPT_INTEREST_FINE 20          // 兴趣度达到此值的扇区细扫
+#define ADAPT_INTEREST_BASE 10          // 空扇区的调度权重
+
+// 14. 告警快速通道 (回波中断直接按原始读数判定，不经过滤波器)
+#define ALARM_CONFIRM_PINGS 2 // 连续 N 次原始读数在危险距离内才确认告警 (防单次毛刺)
+#define ALARM_HOLD_MS 300     // 最后一次危险读数后告警保持时间
+#define ALARM_POLL_MS 100     // 告警任务无事件时的唤醒周期 (检查保持到期)
+#define ALARM_EVT_NEAR 0x1    // 原始读数在危险距离内
+#define ALARM_EVT_FAR 0x2     // 原始读数在危险距离外或无回波
+#define ALARM_EVT_STATE 0x4   // 跟踪器的告警等级已更新
+#define ALARM_HIST_BINS 8     // 告警延迟直方图桶数，边界见 g_alarmHistEdgesMs
+
+// 15. 目标跟踪 (每帧把相邻角度聚成目标，常速度 α-β 跟踪，按碰撞时间告警)
+#define TRACK_MAX 8                 // 同时跟踪的目标数上限 (静态数组，不用堆)
+#define TRACK_MAX_RANGE_MM 2000     // 超出此距离的回波不参与跟踪
+#define TRACK_CLUSTER_GAP_MM 150    // 相邻角度距离差小于此值归为同一目标
+#define TRACK_GATE_DEG 20           // 关联门：方位差
+#define TRACK_GATE_MM 300           // 关联门：与预测距离之差
+#define TRACK_ALPHA_Q16 39322       // 距离增益 0.6 (Q16，与逐角度滤波一样全用整数运算)
+#define TRACK_BETA_Q16 19661        // 速度增益 0.3 (Q16)
+#define TRACK_VEL_MAX_MMS 10000     // 速度限幅 (远超实际目标，只为定点运算不溢出)
+#define TRACK_DT_MAX_MS 5000        // 预测时间上限
+#define TRACK_CONFIRM_HITS 3        // 关联次数达到后才输出速度与碰撞时间 (两次毛刺碰巧关联不会触发)
+#define TRACK_MAX_MISSES 3          // 所在角度已刷新却连续未关联的次数，达到后删除
+#define TRACK_MIN_CLOSING_MMS 50    // 接近速度低于此值视为静止，不计算碰撞时间
+#define TRACK_SAMPLE_MIN_MS 300     // 逐样本更新的最短间隔，更短 (扫描端点折返) 时速度噪声太大，留给整帧关联
+#define TTC_ALARM_MS 1500           // 碰撞时间低于此值为危险
+#define TTC_WARNING_MS 3000         // 碰撞时间低于此值为警告
+#define TTC_NONE 0xFFFF             // 不在接近中
+
+// 16. 静态背景模型 (每个角度学习家具/墙面的距离分布，只把偏离背景的读数标为前景)
+#define BG_DEFAULT_ENABLED 1
+#define BG_MODES 2                  // 每个角度的距离模式数 (波束边缘会交替看到两个表面)
+#define BG_LEARN_SAMPLES 8          // 每个角度学满此样本数后才开始区分前景 (此前全部视为前景)
+#define BG_ALPHA_Q16 1966           // 学习期后的更新率 0.03 (Q16)，约 33 个样本的记忆
+#define BG_WEIGHT_MIN_Q16 13107     // 模式占全部样本的比例达到 0.2 (Q16) 才算背景
+#define BG_K_SIGMA 3                // 与模式均值相差 K 倍标准差以内算匹配
+#define BG_SIGMA_MIN_MM 30          // 标准差下限 (测距噪声)
+#define BG_MIN_DELTA_MM 100         // 匹配门限下限
+#define BG_MQTT_HEARTBEAT 10        // 无前景时每隔多少帧仍上报一次
+
+// 17. 测距流水线基准 (启动时对比原浮点实现与定点实现的 CPU 周期，结果打印到串口)
+#ifndef RADAR_BENCH
+#define RADAR_BENCH 0               // 编译时 -DRADAR_BENCH=1 开启
+#endif
+#define BENCH_SAMPLES 2000          // 每种实现处理的模拟回波数
+
+// 18. OLED 雷达图几何 (极坐标到像素的整数表，编译期由常量表达式生成)
+#define GEO_CX 64         // 雷达原点：屏幕底边中点
+#define GEO_CY 63
+#define GEO_RADIUS_PX 45  // 满量程 (DISPLAY_RANGE_CM) 对应的像素半径，改动需同步 GEO_ROW
+#define GEO_ANGLES 181    // 0~180°，1° 分辨率
+
+// 19. OLED 脏区刷新 (本地帧缓冲与面板内容比对，只发送变化的页/列)
+#define OLED_PAGES 8
+#define OLED_WIDTH 128
+#define OLED_FLUSH_GAP 4  // 两段变化之间相同字节不超过此数时合并发送 (重新寻址要 3 个命令字节)
+#define OLED_EVT_KICK 0x1 // 前台缓冲已交给传输任务
+#define OLED_EVT_IDLE 0x2 // 传输完成，前台缓冲可以再次交换
+#define OLED_EVT_STATE 0x4 // 扫描任务发布了新样本 (只是唤醒显示任务，数据从状态快照取)
+
+// 20. OLED 帧合成 (静态底图与字格在显示任务启动时预渲染，每帧只贴图)
+#define OLED_RING_COUNT 4   // 距离环数，等分满量程，最外一环实线
+#define OLED_RING_DOT_PX 4  // 内环点距 (像素)
+#define OLED_TICK_DEG 30    // 方位刻度间隔
+#define OLED_TICK_PX 4      // 刻度向内的长度
+#define OLED_ANGLE_X 42     // 标题栏：角度数字 (3 位)、"^"、距离数字 (3 位)、"cm" 的起始列
+#define OLED_RANGE_X 74
+#define OLED_NOTICE_X 103   // 网络故障提示 (雷达区右上角 2 行 x 4 字)
+
+// 21. 指示输出引擎 (LED 闪烁与蜂鸣节拍由高精度定时器按边沿驱动，音调由 PWM 产生)
+#define IND_BEEP_PIN HI_IO_NAME_GPIO_7        // 蜂鸣器引脚，复用为 PWM0 输出
+#define IND_BEEP_PIN_FUN HI_IO_FUNC_GPIO_7_PWM0_OUT
+#define IND_BEEP_PWM HI_PWM_PORT_PWM0
+#define IND_PWM_CLK_HZ 160000000U             // PWM 时钟 (PWM_CLK_160M)，分频系数 = 时钟 / 音调，不超过 65535
+#define IND_TONE_MIN_HZ ((IND_PWM_CLK_HZ + 65534U) / 65535U) // 分频系数只有 16 位：最低音调约 2442 Hz
+#define IND_TONE_HZ 4000                      // 危险告警音调
+#if IND_TONE_HZ < IND_TONE_MIN_HZ
+#error "IND_TONE_HZ is below what the 16-bit PWM divider can produce at IND_PWM_CLK_HZ"
+#endif
+#define IND_WARN_FAST_MS 100                  // 警告闪烁周期：碰撞时间为 TTC_ALARM_MS 时
+#define IND_WARN_SLOW_MS 500                  // 碰撞时间为 TTC_WARNING_MS 时
+#define IND_WARN_STEP_MS 20                   // 闪烁周期量化步长，碰撞时间小幅抖动不重启节拍
 
 /* ============================================================
  * 数据结构定义
@@ -67,49 +233,841 @@ typedef enum
     ALARM_DANGER    // 危险状态
 } AlarmState_t;
 
+typedef enum
+{
+    RANGING_DECIMATED = 0, // 原设计：每 10 步测一次，其余角度沿用滤波值
+    RANGING_PIPELINED      // 流水线：每步都测距，样本处理与下一次回波在途重叠
+} RangingMode_t;
+
+typedef enum
+{
+    SCAN_STEP = 0,   // 逐步：转一步、等稳定、测一次
+    SCAN_CONTINUOUS, // 连续：舵机匀速转动，按固定节拍测距，角度按回波时刻插值
+    SCAN_ADAPTIVE,   // 自适应：按扇区调度，有目标的扇区细扫且更常访问，空扇区粗扫
+    SCAN_STRATEGY_COUNT
+} ScanStrategy_t;
+
+typedef enum
+{
+    FILTER_MEDIAN = 0, // 中值滤波：抑制单次毛刺
+    FILTER_ALPHA_BETA  // α-β 滤波：跟踪距离与接近速度
+} FilterMode_t;
+
+typedef enum
+{
+    SWEEP_FORMAT_JSON = 0, // 整帧 JSON (HTML 端直接解析)
+    SWEEP_FORMAT_BINARY    // 紧凑二进制，距离按上一条上报差分编码 (格式见 radar_sweep.h)
+} SweepFormat_t;
+
+typedef enum
+{
+    OLED_STATUS_SCAN = 0, // 标题栏状态字样
+    OLED_STATUS_STOP,
+    OLED_STATUS_WARN,
+    OLED_STATUS_ALARM,
+    OLED_STATUS_COUNT
+} OledStatus_t;
+
 typedef struct
 {
-    float distance;
-    uint16_t angle;
-    AlarmState_t alarmState;
+    uint16_t window[FILTER_MEDIAN_N]; // 中值窗口 (环形，mm)
+    uint8_t count;
+    uint8_t head;
+    uint8_t rejects;
+    uint8_t misses;
+    int32_t rangeMm;  // 滤波输出，0 表示该角度无目标
+    int32_t rateMmS;  // α-β 速度估计
+    uint32_t lastUs;  // 上次更新时刻
+} BinFilter_t;
+
+// 跟踪目标 (随扫描帧发布)
+typedef struct
+{
+    uint8_t id;       // 目标编号，跟踪期间不变
+    uint8_t bearing;  // 方位 (度)
+    uint16_t rangeMm; // 距离
+    int16_t velMmS;   // 径向速度，负值表示靠近
+    uint16_t ttcMs;   // 碰撞时间，TTC_NONE 表示不在接近中
+} RadarObject_t;
+
+typedef struct
+{
+    uint32_t seq;                        // 帧序号，从 1 开始
+    uint32_t startMs;                    // 本帧开始扫描的时刻
+    uint32_t endMs;                      // 本帧发布的时刻
+    int8_t direction;                    // 1: 角度递增扫描, -1: 递减
+    uint16_t rangeMm[RADAR_FRAME_BINS];  // 各角度距离 (mm)，0 表示无目标
+    uint32_t stampMs[RADAR_FRAME_BINS];  // 各角度最近一次测距时刻，0 表示从未测到
+    uint8_t fgMask[(RADAR_FRAME_BINS + 7) / 8]; // 前景位图：该角度读数偏离背景
+    uint8_t fgCount;                     // 前景角度数
+    uint8_t objectCount;                 // 发布时由跟踪器填入
+    RadarObject_t objects[TRACK_MAX];
+} RadarFrame_t;
+
+typedef enum
+{
+    FRAME_CONSUMER_DISPLAY = 0, // OLED 显示
+    FRAME_CONSUMER_MQTT,        // MQTT 上报
+    FRAME_CONSUMER_LOG,         // 串口日志
+    FRAME_CONSUMER_COUNT
+} FrameConsumerId_t;
+
+typedef struct
+{
+    RadarFrame_t frame; // 必须是第一个成员，消费者拿到的指针即槽位地址
+    uint8_t refs;       // 引用计数，0 表示空闲
+} FrameSlot_t;
+
+typedef struct
+{
+    osMessageQueueId_t mailbox; // 帧指针邮箱
+    const char *name;
+    volatile uint8_t attached;  // 未挂接的消费者不占用帧
+    uint32_t received;          // 已取走的帧数
+    uint32_t dropped;           // 邮箱满时被挤掉的帧数
+    uint32_t lagMsSum;          // 发布到取走的累计延迟
+    uint32_t lagMsMax;
+} FrameConsumer_t;
+
+typedef struct
+{
+    uint32_t sweeps;
+    uint32_t samples;   // 累计有效测距次数
+    uint32_t elapsedUs; // 累计扫描耗时
+} RangingStats_t;
+
+typedef struct
+{
+    uint16_t angle;          // 当前扫描角度
+    uint16_t rangeMm;        // 当前角度滤波后距离 (mm)
     SystemState_t sysState;
-} RadarData_t;
+    AlarmState_t alarmState;
+    uint8_t scanEnabled;
+} RadarState_t;
+
+typedef enum
+{
+    SR04_PHASE_IDLE = 0,
+    SR04_PHASE_WAIT_RISE, // 已触发，等待回波上升沿
+    SR04_PHASE_WAIT_FALL  // 回波进行中，等待下降沿
+} Sr04Phase_t;
+
+typedef enum
+{
+    GATE_NEAR = 0, // 近场快速门
+    GATE_SURVEY,   // 全量程
+    GATE_COUNT
+} RangeGate_t;
+
+typedef struct
+{
+    uint32_t pings;
+    uint32_t echoes;    // 有效回波
+    uint32_t noEcho;    // 门内无回波 (含模块自身报告的无回波)
+    uint32_t timeouts;  // 超时仍未收到完整回波
+    uint32_t busyWaits; // 上次回波在门外仍未结束，触发前需等模块空闲
+    uint32_t flightUs;  // 累计在途时间，原忙等方案会占满这段 CPU
+} Sr04Stats_t;
+
+typedef struct
+{
+    uint32_t pings;
+    uint32_t elapsedUs;
+} GateStats_t;
+
+typedef struct
+{
+    uint32_t baseUs;   // 与转角无关的时延
+    uint32_t perDegUs; // 每度转动时间
+    uint8_t calibrated;
+} ServoModel_t;
+
+// 扇区访问间隔统计 (按扫描策略分别累计)
+typedef struct
+{
+    uint32_t visits;
+    uint32_t intervalMsSum;
+    uint32_t intervalMsMax;
+} RevisitStats_t;
+
+// 告警延迟：首次危险读数的触发时刻到蜂鸣器/LED 输出
+typedef struct
+{
+    uint32_t count;
+    uint32_t sumUs;
+    uint32_t maxUs;
+    uint32_t rejects;  // 未达到确认次数就中断的危险读数序列 (视为毛刺)
+    uint32_t hist[ALARM_HIST_BINS];
+} AlarmLatencyStats_t;
+
+// 跟踪器内部状态
+typedef struct
+{
+    uint8_t active;
+    uint8_t id;
+    uint8_t hits;
+    uint8_t misses;
+    int32_t bearingQ8; // 方位，Q8 度
+    int32_t rangeMm;
+    int32_t velMmS;    // 径向速度 (靠近为负)
+    uint32_t lastMs;   // 最近一次关联的测量时刻
+} Track_t;
+
+// 一帧中聚出的目标
+typedef struct
+{
+    int32_t bearingQ8; // 各角度的平均方位，Q8 度
+    int32_t rangeMm;   // 最近的角度的距离
+    uint32_t stampMs;
+    uint8_t used;
+} TrackCluster_t;
+
+#if RADAR_BENCH
+// 原浮点滤波器状态 (仅供基准对比)
+typedef struct
+{
+    float window[FILTER_MEDIAN_N];
+    uint8_t count;
+    uint8_t head;
+    uint8_t rejects;
+    float range; // cm
+    float rate;  // cm/s
+    uint32_t lastUs;
+} BenchFloatBin_t;
+#endif
+
+// OLED 雷达图像素坐标
+typedef struct
+{
+    uint8_t x;
+    uint8_t y;
+} GeoPoint_t;
+
+// OLED 每帧绘制耗时 (绘制按 CPU 周期计，刷屏按时间计) 与刷新量，只由显示任务写
+typedef struct
+{
+    uint32_t frames;
+    uint64_t drawCycles;
+    uint32_t drawCyclesMax;
+    uint64_t refreshUs;
+    uint64_t bytes;     // 刷新发出的 I2C 字节 (含页/列寻址命令)
+    uint32_t bytesMax;
+    uint32_t firstMs;   // 第一帧与最近一帧的时刻，用于计算实际帧率
+    uint32_t lastMs;
+    uint64_t swapWaitUs; // 交换缓冲时等上一帧传输完成的时间
+} RenderStats_t;
+
+// 最近一次刷屏的耗时与字节数，只由传输任务写；置 OLED_EVT_IDLE 后不再改动，由 Oled_Swap 并入 RenderStats_t
+typedef struct
+{
+    uint32_t refreshUs;
+    uint32_t bytes;
+} OledTxStats_t;
+
+// 指示输出图案：每一路 periodMs 为 0 时按 onMs 非零常亮/为零常灭，否则每周期亮 onMs
+typedef struct
+{
+    uint16_t ledPeriodMs;
+    uint16_t ledOnMs;
+    uint16_t beepPeriodMs;
+    uint16_t beepOnMs;
+    uint16_t toneHz; // 0 取 IND_TONE_HZ；不低于 IND_TONE_MIN_HZ
+} IndicatorPattern_t;
+
+#if RADAR_BENCH
+typedef struct
+{
+    uint32_t samples;
+    uint32_t floatCycles[2]; // [中值, α-β]
+    uint32_t fixedCycles[2];
+    uint32_t maxErrMm[2];    // 两种实现输出的最大差值
+    uint32_t geoFrames;      // 雷达图坐标计算的帧数
+    uint32_t geoFloatCycles; // 原浮点正弦 + 乘法
+    uint32_t geoTableCycles; // 几何表查找
+} BenchResult_t;
+#endif
+
+// 单个角度的一个距离模式
+typedef struct
+{
+    int32_t meanQ8;  // 均值 (mm，Q8：慢速更新时每次修正不足 1 mm)
+    uint32_t varMm2; // 方差
+    uint32_t weight; // 占全部样本 (含无回波) 的比例 (Q16)
+} BgMode_t;
+
+// 单个角度的背景模型
+typedef struct
+{
+    BgMode_t mode[BG_MODES];
+    uint16_t n;   // 已学习样本数 (到 BG_LEARN_SAMPLES 为止)
+    uint8_t fg;   // 最近一次读数是否为前景
+} BgBin_t;
+
+typedef struct
+{
+    uint32_t samples;    // 参与分类的读数
+    uint32_t foreground; // 其中的前景读数
+    uint32_t absorbed;   // 新模式成为背景的次数 (搬来的家具、停下的人)
+    uint32_t mqttSkipped; // 无前景而省去的上报
+} BgStats_t;
+
+// 整帧上报统计 (仅 MQTT 任务写)
+typedef struct
+{
+    uint32_t frames;      // 收到的扫描帧
+    uint32_t published;   // 上报的帧
+    uint32_t rateSkipped; // 距上次上报不足最小间隔而跳过
+    uint32_t truncated;   // 缓冲不足、目标列表被截断
+    uint32_t keyframes;   // 二进制格式的关键帧
+    uint64_t bytes;
+    uint32_t bytesMax;
+} SweepPubStats_t;
+
+typedef struct
+{
+    uint32_t acquires;
+    uint32_t contended;  // 需要等待的次数
+    uint32_t waitUs;     // 累计等待时间
+    uint32_t maxWaitUs;
+    uint32_t readRetries; // 快照读取因写者并发而重读的次数 (多个读者并发累加，原子递增)
+} StateLockStats_t;
 
 /* ============================================================
  * 全局变量
  * ============================================================ */
 static osThreadId_t g_scanTaskHandle = NULL;
 static osThreadId_t g_displayTaskHandle = NULL;
-static osThreadId_t g_mqttTaskHandle = NULL; // 负责 MQTT 通信
-static osMessageQueueId_t g_dataQueue = NULL;
-static osMutexId_t g_systemMutex = NULL;
-
-// 系统状态变量
-static SystemState_t g_systemState = SYSTEM_SCANNING;
-static AlarmState_t g_alarmState = ALARM_SAFE;
-static uint16_t g_currentAngle = 90;
-static float g_currentDistance = 0;
-static uint8_t g_scanEnabled = 1;
+static osThreadId_t g_mqttTaskHandle = NULL; // 负责整帧上报
+static osMutexId_t g_systemMutex = NULL; // 仅用于写者之间互斥 (状态与滤波器组)
+
+// 系统状态：写者持 g_systemMutex 经 State_Publish() 修改，读者用 State_Read() 无锁快照
+static RadarState_t g_state = {90, 0, SYSTEM_SCANNING, ALARM_SAFE, 1};
+static volatile uint32_t g_stateSeq = 0; // 奇数表示正在写
+static StateLockStats_t g_stateLockStats = {0};
 static uint8_t g_distanceUpdateCounter = 0;
+static RangingMode_t g_rangingMode = RANGING_DEFAULT_MODE;
+static RangingStats_t g_rangingStats[2] = {0};
+static ScanStrategy_t g_scanStrategy = SCAN_DEFAULT_STRATEGY;
+static RangingStats_t g_scanStats[SCAN_STRATEGY_COUNT] = {0};
+static const char *const g_scanStrategyName[SCAN_STRATEGY_COUNT] = {"step", "continuous", "adaptive"};
+static osTimerId_t g_contServoTimer = NULL; // 连续扫描时按轨迹刷新舵机指令
+static int32_t g_contFromQ8 = 90 * 256; // 本趟轨迹起止角度，Q8 度
+static int32_t g_contToQ8 = 90 * 256;
+static uint32_t g_contT0 = 0;
+static volatile uint32_t g_contTickSkips = 0; // 舵机锁被占用而放弃的定时器节拍
+static uint8_t g_sectorInterest[ADAPT_SECTOR_COUNT] = {0};
+static uint32_t g_sectorSeenMs[ADAPT_SECTOR_COUNT] = {0}; // 各扇区最近一次进入的时刻
+static int8_t g_sectorLast = -1;                          // 上一个样本所在扇区，-1 表示下一样本算新的访问
+static ScanStrategy_t g_sectorStrategy = SCAN_DEFAULT_STRATEGY; // 访问间隔统计当前归属的策略
+static uint32_t g_sectorStrategyMs = 0;                    // 切换到该策略的时刻，更早的访问不参与间隔统计
+static RevisitStats_t g_revisitStats[SCAN_STRATEGY_COUNT][ADAPT_SECTOR_COUNT] = {0};
+static FilterMode_t g_filterMode = FILTER_DEFAULT_MODE;
+static BinFilter_t g_binFilter[RADAR_BIN_COUNT];
+
+// 扫描帧池：扫描任务独占写后台帧，扫描结束时按指针投递给各消费者
+static FrameSlot_t g_framePool[FRAME_POOL_SIZE];
+static RadarFrame_t *g_frameBack = NULL;   // 正在写入的帧
+static RadarFrame_t *g_frameLatest = NULL; // 最近发布的帧，池自身持有一个引用
+static uint32_t g_framePoolExhausted = 0;  // 无空闲帧而推迟发布的次数
+static FrameConsumer_t g_frameConsumers[FRAME_CONSUMER_COUNT] = {
+    [FRAME_CONSUMER_DISPLAY] = {.name = "display"},
+    [FRAME_CONSUMER_MQTT] = {.name = "mqtt"},
+    [FRAME_CONSUMER_LOG] = {.name = "log"},
+};
+static osMutexId_t g_frameMutex = NULL;
+
+// 异步测距：中断只写时间戳并置事件标志
+static volatile Sr04Phase_t g_sr04Phase = SR04_PHASE_IDLE;
+static volatile uint32_t g_sr04RiseUs = 0;
+static volatile uint32_t g_sr04WidthUs = 0;
+static uint32_t g_sr04TrigUs = 0;
+static uint32_t g_sr04EchoUs = 0; // 最近一次声波到达目标的时刻 (无回波时为触发时刻)
+static osEventFlagsId_t g_sr04Event = NULL;
+static hi_u32 g_sr04GateTimer = 0;
+static uint32_t g_sr04GateUs = 0; // 本次测距的门宽 (回波脉宽上限)
+static Sr04Stats_t g_sr04Stats = {0};
+static RangeGate_t g_rangeGate = RANGE_GATE_DEFAULT;
+static const uint16_t g_gateRangeCm[GATE_COUNT] = {RANGE_GATE_NEAR_CM, RANGE_GATE_SURVEY_CM};
+static GateStats_t g_gateStats[GATE_COUNT] = {0};
+
+// 告警快速通道：回波中断分类原始读数，告警任务独占蜂鸣器与 LED
+static osEventFlagsId_t g_alarmEvent = NULL;
+static volatile uint32_t g_alarmPingUs = 0; // 最近一次危险读数的触发时刻
+static volatile uint32_t g_alarmLastRaw = 0; // 最后到达的原始读数事件 (NEAR/FAR)，告警任务据此排出先后
+static AlarmLatencyStats_t g_alarmLatency = {0};
+static const uint16_t g_alarmHistEdgesMs[ALARM_HIST_BINS - 1] = {5, 10, 20, 50, 100, 200, 500};
+
+// 静态背景模型 (仅扫描任务更新)
+static uint8_t g_bgEnabled = BG_DEFAULT_ENABLED;
+static BgBin_t g_bgBins[RADAR_FRAME_BINS] = {0};
+static BgStats_t g_bgStats = {0};
+
+// 整帧上报
+static volatile uint32_t g_sweepMinIntervalMs = MQTT_SWEEP_MIN_INTERVAL_MS;
+static volatile SweepFormat_t g_sweepFormat = MQTT_SWEEP_DEFAULT_FORMAT;
+static volatile uint8_t g_sweepKeyRequest = 1;                    // 下一条二进制上报发关键帧
+static uint16_t g_sweepBaseMm[RADAR_FRAME_BINS] = {0};           // 差分基准：上一条二进制上报的距离
+static uint32_t g_sweepBaseSeq = 0;
+static SweepPubStats_t g_sweepPubStats = {0};
+static volatile uint8_t g_bgResetRequest = 0; // MQTT 线程置位，扫描任务执行
+
+#if RADAR_BENCH
+// 测距流水线基准结果
+static BenchResult_t g_benchResult = {0};
+#endif
+
+// OLED 绘制耗时与刷新量 (显示任务写，传输任务的计数经 Oled_Swap 交接)
+static RenderStats_t g_renderStats = {0};
+static OledTxStats_t g_oledTxStats = {0};
+
+// OLED 显示层：双缓冲。后台缓冲与其脏列范围只由显示任务绘制；
+// 前台缓冲、其脏列范围和面板当前内容只由传输任务访问，两者经 Oled_Swap() 交接
+static uint8_t g_oledBuf[2][OLED_PAGES][OLED_WIDTH];
+static uint8_t (*g_oledFb)[OLED_WIDTH] = g_oledBuf[0];    // 后台 (绘制)
+static uint8_t (*g_oledFront)[OLED_WIDTH] = g_oledBuf[1]; // 前台 (传输)
+static uint8_t g_oledPanel[OLED_PAGES][OLED_WIDTH];
+static uint8_t g_oledDirtyLo[OLED_PAGES];
+static uint8_t g_oledDirtyHi[OLED_PAGES];
+static uint8_t g_oledTxLo[OLED_PAGES];
+static uint8_t g_oledTxHi[OLED_PAGES];
+static osEventFlagsId_t g_oledEvent = NULL;
+
+// OLED 帧合成的预渲染层 (显示任务启动时生成)：静态底图、8x16 数字字格 (0~9 与空格)、状态字样
+static uint8_t g_oledStatic[OLED_PAGES][OLED_WIDTH];
+static uint8_t g_oledDigit[11][2][8];
+static uint8_t g_oledStatus[OLED_STATUS_COUNT][2][40];
+static uint8_t g_oledNotice[2][24];
+static const char *const g_oledStatusText[OLED_STATUS_COUNT] = {"SCAN ", "STOP ", "WARN ", "ALARM"};
+
+// 目标跟踪 (仅扫描任务在发布帧时更新)
+static Track_t g_tracks[TRACK_MAX] = {0};
+static uint8_t g_trackNextId = 1;
+static uint16_t g_trackRawMm[RADAR_FRAME_BINS] = {0};    // 跟踪器输入：各角度最近一次原始读数 (不经逐角度滤波)
+static uint32_t g_trackRawMs[RADAR_FRAME_BINS] = {0};    // 对应的测距时刻
+static uint32_t g_trackLastMs = 0;                    // 上次跟踪时刻，之后刷新过的角度才算新测量
+static volatile AlarmState_t g_trackAlarm = ALARM_SAFE; // 按碰撞时间得出的告警等级
+static volatile uint16_t g_trackTtcMs = TTC_NONE;        // 所有目标中最短的碰撞时间
+
+// 舵机运动模型：记录最近一次指令角度与预计稳定时刻。
+// 扫描任务、连续扫描定时器和启停 (按键/MQTT 回调) 都会转舵机，改写这几项须持 g_servoMutex
+static ServoModel_t g_servoModel = {SERVO_MODEL_BASE_US, SERVO_MODEL_PER_DEG_US, 0};
+static uint16_t g_servoTarget = 90;
+static uint32_t g_servoReadyUs = 0;
+static osMutexId_t g_servoMutex = NULL;
+static volatile uint8_t g_servoCalRequest = 0;
+static uint8_t g_servoCalibrating = 0; // 只由扫描任务写：标定期间测距固定用近距离门，不动 g_rangeGate
+static const uint8_t g_servoCalSteps[] = {20, 40, 60, 90};
 
 /* ============================================================
  * 基础功能函数
  * ============================================================ */
 
-// 本地蜂鸣器定义 (避免修改 common 库文件)
-#define MY_BEEP_PIN HI_IO_NAME_GPIO_7
-#define MY_BEEP_GPIO_FUN HI_IO_FUNC_GPIO_7_GPIO
+/* ============================================================
+ * 指示输出引擎 (LED + 蜂鸣器)
+ * 调用者设置一次图案，之后由硬件执行：音调由 PWM0 (GPIO7 复用) 产生，
+ * 闪烁与鸣叫节拍由高精度定时器在每个边沿中断一次、切换输出并预约下一个边沿；
+ * 常亮/常灭的图案不占用定时器。图案不变时重复设置不会打断节拍。
+ * ============================================================ */
+static IndicatorPattern_t g_indPattern = {0};
+static uint32_t g_indStartUs = 0; // 当前图案的时间轴起点
+static uint32_t g_indTimer = 0;
+static uint8_t g_indLed = 0;      // 两路当前输出
+static uint8_t g_indBeep = 0;
+static uint16_t g_indToneHz = 0;
+
+static void Indicator_Init(void)
+{
+    hi_gpio_init();
+    hi_io_set_func(IND_BEEP_PIN, IND_BEEP_PIN_FUN);
+    hi_pwm_set_clock(PWM_CLK_160M);
+    hi_pwm_init(IND_BEEP_PWM);
+    hi_hrtimer_create(&g_indTimer);
+}
+
+/* 一路输出在图案时间轴 t (us) 处的电平，*nextUs 给出到下一个边沿的时间 (常亮/常灭为 0) */
+static uint8_t Indicator_Level(uint16_t periodMs, uint16_t onMs, uint32_t t, uint32_t *nextUs)
+{
+    if (periodMs == 0 || onMs == 0 || onMs >= periodMs)
+    {
+        *nextUs = 0;
+        return onMs != 0;
+    }
+    uint32_t periodUs = periodMs * 1000u;
+    uint32_t onUs = onMs * 1000u;
+    uint32_t phase = t % periodUs;
+    *nextUs = phase < onUs ? onUs - phase : periodUs - phase;
+    return phase < onUs;
+}
+
+/* 边沿处理 (定时器中断回调；设置图案时也直接调用一次)：按图案驱动两路输出并预约下一个边沿 */
+static void Indicator_Edge(hi_u32 data)
+{
+    (void)data;
+    const IndicatorPattern_t *p = &g_indPattern;
+    uint32_t t = hi_get_us() - g_indStartUs;
+    uint32_t ledNext, beepNext;
+    uint8_t led = Indicator_Level(p->ledPeriodMs, p->ledOnMs, t, &ledNext);
+    uint8_t beep = Indicator_Level(p->beepPeriodMs, p->beepOnMs, t, &beepNext);
+
+    if (led != g_indLed)
+    {
+        LED(led);
+        g_indLed = led;
+    }
+    if (beep && (!g_indBeep || g_indToneHz != p->toneHz))
+    {
+        uint32_t div = IND_PWM_CLK_HZ / (p->toneHz ? p->toneHz : IND_TONE_HZ); // Indicator_Set 已限幅
+        hi_pwm_start(IND_BEEP_PWM, (hi_u16)(div / 2), (hi_u16)div);
+        g_indToneHz = p->toneHz;
+    }
+    else if (!beep && g_indBeep)
+    {
+        hi_pwm_stop(IND_BEEP_PWM);
+    }
+    g_indBeep = beep;
 
-// 重定义 BEEP 宏
-#undef BEEP
-#define BEEP(a) hi_gpio_set_ouput_val(MY_BEEP_PIN, a)
+    uint32_t next = ledNext;
+    if (beepNext != 0 && (next == 0 || beepNext < next))
+        next = beepNext;
+    if (next != 0)
+        hi_hrtimer_start(g_indTimer, next, Indicator_Edge, 0);
+}
 
-static void Local_Beep_Init(void)
+/* 设置图案 (任务上下文)。与当前图案相同时直接返回；
+ * 低于 IND_TONE_MIN_HZ 的音调分频系数会溢出，按最低音调发声 */
+static void Indicator_Set(const IndicatorPattern_t *pattern)
 {
-    hi_gpio_init();
-    hi_io_set_pull(MY_BEEP_PIN, HI_IO_PULL_UP);
-    hi_io_set_func(MY_BEEP_PIN, MY_BEEP_GPIO_FUN);
-    hi_gpio_set_dir(MY_BEEP_PIN, HI_GPIO_DIR_OUT);
+    IndicatorPattern_t p = *pattern;
+    if (p.toneHz != 0 && p.toneHz < IND_TONE_MIN_HZ)
+        p.toneHz = IND_TONE_MIN_HZ;
+    if (memcmp(&p, &g_indPattern, sizeof(p)) == 0)
+        return;
+    hi_hrtimer_stop(g_indTimer);
+    g_indPattern = p;
+    g_indStartUs = hi_get_us();
+    Indicator_Edge(0);
+}
+
+/* ============================================================
+ * 异步测距驱动 (基于 bsp_sr04 的引脚定义)
+ * sr04_read_distance() 触发后忙等回波，最长约 38ms 占满 CPU。
+ * 这里改为：触发后立即返回，ECHO 上升/下降沿在中断里打时间戳，
+ * 下降沿置事件标志；扫描任务阻塞在事件标志上，期间 CPU 让给其他任务。
+ * 距离门：高精度定时器在门宽到期时置标志，门外的回波不再等待；
+ * 模块仍会输出到回波结束，下次触发前等它空闲。
+ * ============================================================ */
+
+/* 毫秒转系统节拍 (向上取整) */
+static uint32_t Radar_MsToTicks(uint32_t ms)
+{
+    return (ms * osKernelGetTickFreq() + 999) / 1000;
+}
+
+/* ECHO 边沿中断：只记录时间并切换下一次等待的边沿 */
+static void Sr04Async_EchoIsr(void *arg)
+{
+    (void)arg;
+    uint32_t now = hi_get_us();
+    if (g_sr04Phase == SR04_PHASE_WAIT_RISE)
+    {
+        g_sr04RiseUs = now;
+        g_sr04Phase = SR04_PHASE_WAIT_FALL;
+        hi_gpio_set_isr_mode(SR04_ECHO_PIN, HI_INT_TYPE_EDGE, HI_GPIO_EDGE_FALL_LEVEL_LOW);
+    }
+    else if (g_sr04Phase == SR04_PHASE_WAIT_FALL)
+    {
+        g_sr04WidthUs = now - g_sr04RiseUs;
+        g_sr04Phase = SR04_PHASE_IDLE;
+        hi_gpio_set_isr_mode(SR04_ECHO_PIN, HI_INT_TYPE_EDGE, HI_GPIO_EDGE_RISE_LEVEL_HIGH);
+        osEventFlagsSet(g_sr04Event, SR04_EVT_DONE);
+        // 告警快速通道：原始脉宽直接比较，不等扫描任务和滤波器
+        if (g_sr04WidthUs < SR04_ECHO_US(ALARM_DISTANCE_CM))
+        {
+            g_alarmPingUs = g_sr04TrigUs;
+            g_alarmLastRaw = ALARM_EVT_NEAR;
+            osEventFlagsSet(g_alarmEvent, ALARM_EVT_NEAR);
+        }
+        else
+        {
+            g_alarmLastRaw = ALARM_EVT_FAR;
+            osEventFlagsSet(g_alarmEvent, ALARM_EVT_FAR);
+        }
+    }
+}
+
+/* 等待到指定时刻 (usleep 按节拍对齐，可能提前返回，需循环) */
+static void Radar_WaitUntil(uint32_t deadlineUs)
+{
+    int32_t remain = (int32_t)(deadlineUs - hi_get_us());
+    while (remain > 0)
+    {
+        usleep((uint32_t)remain);
+        remain = (int32_t)(deadlineUs - hi_get_us());
+    }
+}
+
+/* 距离门到期 (定时器中断) */
+static void Sr04Async_GateIsr(hi_u32 data)
+{
+    (void)data;
+    if (g_sr04Phase != SR04_PHASE_IDLE)
+    {
+        osEventFlagsSet(g_sr04Event, SR04_EVT_GATE);
+        g_alarmLastRaw = ALARM_EVT_FAR;
+        osEventFlagsSet(g_alarmEvent, ALARM_EVT_FAR);
+    }
+}
+
+static void Sr04Async_Init(void)
+{
+    g_sr04Event = osEventFlagsNew(NULL);
+    hi_hrtimer_create(&g_sr04GateTimer);
+    hi_gpio_register_isr_function(SR04_ECHO_PIN, HI_INT_TYPE_EDGE, HI_GPIO_EDGE_RISE_LEVEL_HIGH,
+                                  Sr04Async_EchoIsr, NULL);
+}
+
+/* 本次测距使用的距离门。标定期间 MQTT 仍可改 g_rangeGate，标定结束后才生效 */
+static RangeGate_t Sr04Async_Gate(void)
+{
+    return g_servoCalibrating ? GATE_NEAR : g_rangeGate;
+}
+
+/* 当前距离门下两次触发的最小间隔 */
+static uint32_t Sr04Async_GapUs(void)
+{
+    return SR04_ECHO_US(g_gateRangeCm[Sr04Async_Gate()]) + SR04_GAP_MARGIN_US;
+}
+
+/* 发出 20us 触发脉冲并启动距离门定时器后立即返回 */
+static void Sr04Async_Trigger(void)
+{
+    if (g_sr04Phase != SR04_PHASE_IDLE)
+    {
+        // 上次回波在门外，模块仍在输出，此时触发会被忽略
+        g_sr04Stats.busyWaits++;
+        osEventFlagsWait(g_sr04Event, SR04_EVT_DONE, osFlagsWaitAny, Radar_MsToTicks(SR04_ECHO_TIMEOUT_MS));
+    }
+    osEventFlagsClear(g_sr04Event, SR04_EVT_DONE | SR04_EVT_GATE);
+    g_sr04GateUs = SR04_ECHO_US(g_gateRangeCm[Sr04Async_Gate()]);
+    g_sr04Phase = SR04_PHASE_WAIT_RISE;
+    hi_gpio_set_isr_mode(SR04_ECHO_PIN, HI_INT_TYPE_EDGE, HI_GPIO_EDGE_RISE_LEVEL_HIGH);
+    hi_gpio_set_ouput_val(SR04_TRIG_PIN, HI_GPIO_VALUE1);
+    hi_udelay(20);
+    hi_gpio_set_ouput_val(SR04_TRIG_PIN, HI_GPIO_VALUE0);
+    g_sr04TrigUs = hi_get_us();
+    g_sr04Stats.pings++;
+    hi_hrtimer_start(g_sr04GateTimer, SR04_BURST_US + g_sr04GateUs, Sr04Async_GateIsr, 0);
+}
+
+/* 阻塞等待本次测距结果 (mm)；门内无回波或超时返回 0 */
+static int32_t Sr04Async_Wait(void)
+{
+    uint32_t flags = osEventFlagsWait(g_sr04Event, SR04_EVT_DONE | SR04_EVT_GATE, osFlagsWaitAny,
+                                      Radar_MsToTicks(SR04_ECHO_TIMEOUT_MS));
+    g_sr04Stats.flightUs += hi_get_us() - g_sr04TrigUs;
+
+    if (flags & osFlagsError)
+    {
+        // 超时：丢弃半截回波，下次触发重新等上升沿
+        hi_hrtimer_stop(g_sr04GateTimer);
+        g_sr04Phase = SR04_PHASE_IDLE;
+        g_sr04Stats.timeouts++;
+        return 0;
+    }
+    g_sr04EchoUs = g_sr04TrigUs;
+    if (!(flags & SR04_EVT_DONE))
+    {
+        // 距离门到期，回波在门外
+        g_sr04Stats.noEcho++;
+        return 0;
+    }
+    hi_hrtimer_stop(g_sr04GateTimer);
+    g_sr04EchoUs = g_sr04RiseUs + g_sr04WidthUs / 2;
+    if (g_sr04WidthUs >= g_sr04GateUs)
+    {
+        g_sr04Stats.noEcho++;
+        return 0;
+    }
+    g_sr04Stats.echoes++;
+    return (int32_t)SR04_US_TO_MM(g_sr04WidthUs);
+}
+
+/* ============================================================
+ * 舵机运动模型 (基于 bsp_sg90)
+ * 稳定时间按转角估算，扫描任务只等模型预测的时间，不再固定延时；
+ * 模型参数可由 Servo_Calibrate() 对着固定目标边转边测距拟合。
+ * ============================================================ */
+
+/* 转动 deltaDeg 度后的预计稳定时间 */
+static uint32_t Servo_SettleUs(uint16_t deltaDeg)
+{
+    return deltaDeg ? g_servoModel.baseUs + g_servoModel.perDegUs * deltaDeg : 0;
+}
+
+/* 发出转动指令并更新预计稳定时刻，调用者持 g_servoMutex */
+static void Servo_MoveLocked(uint16_t angle)
+{
+    uint16_t delta = angle > g_servoTarget ? angle - g_servoTarget : g_servoTarget - angle;
+    uint32_t ready = hi_get_us() + Servo_SettleUs(delta);
+    set_sg90_angle(angle);
+    g_servoTarget = angle;
+    // 上一次转动尚未完成时以较晚者为准
+    if ((int32_t)(ready - g_servoReadyUs) > 0)
+        g_servoReadyUs = ready;
+}
+
+/* 发出转动指令 (所有转动都应经过这里或 Servo_TryMove，可在任意任务中调用) */
+static void Servo_Move(uint16_t angle)
+{
+    osMutexAcquire(g_servoMutex, osWaitForever);
+    Servo_MoveLocked(angle);
+    osMutexRelease(g_servoMutex);
+}
+
+/* 定时器回调用：不等锁，锁被占用 (标定或启停正在转舵机) 时放弃本次并返回 0。
+ * 软件定时器回调共用一个线程，在这里阻塞会拖住所有定时器 */
+static uint8_t Servo_TryMove(uint16_t angle)
+{
+    if (osMutexAcquire(g_servoMutex, 0) != osOK)
+        return 0;
+    Servo_MoveLocked(angle);
+    osMutexRelease(g_servoMutex);
+    return 1;
+}
+
+/* 标定用：在当前指令下连续测距，直到读数连续两次进入 (onTarget=1) 或离开参考距离带。
+ * 变化发生在最后一次不满足与第一次满足的触发之间，取中点以消除测距间隔带来的偏差。
+ * 下一次触发前模块仍忙说明上一次是模块级无回波 (丢波)，该读数作废。
+ * 返回相对 cmdUs 的时间，超时返回 0 */
+static uint32_t Servo_CalTime(uint32_t cmdUs, int32_t refMm, uint8_t onTarget)
+{
+    uint32_t lastMissUs = cmdUs;
+    uint32_t firstUs = 0;
+    uint32_t prevUs = 0;
+    int8_t prevHit = -1; // 上一次读数的判定，确认有效后才使用
+    while ((int32_t)(cmdUs + SERVO_CAL_TIMEOUT_MS * 1000 - hi_get_us()) > 0)
+    {
+        uint32_t busy = g_sr04Stats.busyWaits;
+        Sr04Async_Trigger();
+        if (g_sr04Stats.busyWaits != busy)
+            prevHit = -1;
+        if (prevHit == (int8_t)onTarget)
+        {
+            if (firstUs != 0)
+                return (lastMissUs + firstUs) / 2 - cmdUs + 1;
+            firstUs = prevUs;
+        }
+        else if (prevHit >= 0)
+        {
+            lastMissUs = prevUs;
+            firstUs = 0;
+        }
+        prevUs = g_sr04TrigUs;
+        int32_t d = Sr04Async_Wait();
+        prevHit = (d > refMm - SERVO_CAL_TOL_CM * 10 && d < refMm + SERVO_CAL_TOL_CM * 10);
+        Radar_WaitUntil(prevUs + Sr04Async_GapUs());
+    }
+    return 0;
+}
+
+/* 标定：参考角度正前方放一个孤立目标，从不同转角转回 (到达) 再转开 (离开)。
+ * 到达时间 = 时延 + 每度时间 × (转角 - 半波束宽)，离开时间 = 时延 + 每度时间 × 半波束宽，
+ * 两者相加消去波束宽，其对转角的斜率即每度时间，截距为两倍时延。 */
+static void Servo_CalRun(void)
+{
+    enum { CAL_N = sizeof(g_servoCalSteps) * SERVO_CAL_REPEAT };
+    uint32_t arrive[CAL_N], leave[CAL_N];
+    float steps[CAL_N];
+    printf("[Servo] calibrating against target at %d deg\n", SERVO_CAL_REF_ANGLE);
+
+    // 1. 参考距离：充分稳定后取 5 次中值
+    Servo_Move(SERVO_CAL_REF_ANGLE);
+    usleep(500 * 1000);
+    int32_t ref[5];
+    for (int i = 0; i < 5; i++)
+    {
+        Sr04Async_Trigger();
+        ref[i] = Sr04Async_Wait();
+        Radar_WaitUntil(g_sr04TrigUs + Sr04Async_GapUs());
+        for (int j = i; j > 0 && ref[j] < ref[j - 1]; j--)
+        {
+            int32_t t = ref[j];
+            ref[j] = ref[j - 1];
+            ref[j - 1] = t;
+        }
+    }
+    int32_t refMm = ref[2];
+    if (refMm <= 0)
+    {
+        printf("[Servo] calibration aborted: no target within %d cm\n", RANGE_GATE_NEAR_CM);
+        return;
+    }
+
+    // 2. 各转角的到达与离开时间
+    int n = 0;
+    for (unsigned s = 0; s < sizeof(g_servoCalSteps); s++)
+    {
+        uint16_t away = SERVO_CAL_REF_ANGLE + g_servoCalSteps[s];
+        for (int r = 0; r < SERVO_CAL_REPEAT; r++)
+        {
+            Servo_Move(away);
+            usleep(500 * 1000);
+            uint32_t t0 = hi_get_us();
+            Servo_Move(SERVO_CAL_REF_ANGLE);
+            arrive[n] = Servo_CalTime(t0, refMm, 1);
+            usleep(300 * 1000);
+            t0 = hi_get_us();
+            Servo_Move(away);
+            leave[n] = Servo_CalTime(t0, refMm, 0);
+            steps[n] = g_servoCalSteps[s];
+            if (arrive[n] == 0 || leave[n] == 0)
+            {
+                printf("[Servo] calibration aborted: no transition for %u deg step\n", g_servoCalSteps[s]);
+                return;
+            }
+            n++;
+        }
+    }
+
+    // 3. 到达+离开时间对转角做最小二乘，斜率即每度时间；时延取各次的最坏值
+    float sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (int i = 0; i < n; i++)
+    {
+        float y = (float)arrive[i] + (float)leave[i];
+        sx += steps[i];
+        sy += y;
+        sxx += steps[i] * steps[i];
+        sxy += steps[i] * y;
+    }
+    float perDeg = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    if (perDeg <= 0)
+    {
+        printf("[Servo] calibration aborted: no slope\n");
+        return;
+    }
+    float latency = 0;
+    for (int i = 0; i < n; i++)
+    {
+        float l = ((float)arrive[i] + (float)leave[i] - perDeg * steps[i]) / 2;
+        if (l > latency)
+            latency = l;
+    }
+    osMutexAcquire(g_servoMutex, osWaitForever);
+    g_servoModel.perDegUs = (uint32_t)(perDeg + 0.5f);
+    g_servoModel.baseUs = (uint32_t)latency + SERVO_SETTLE_MARGIN_US;
+    g_servoModel.calibrated = 1;
+    osMutexRelease(g_servoMutex);
+    printf("[Servo] ref %d mm, base %u us + %u us/deg: %d deg step %u ms, 90 deg %u ms\n", (int)refMm,
+           g_servoModel.baseUs, g_servoModel.perDegUs, SCAN_STEP_ANGLE, Servo_SettleUs(SCAN_STEP_ANGLE) / 1000,
+           Servo_SettleUs(90) / 1000);
+}
+
+/* 舵机标定 (仅扫描任务调用)：标定期间测距改用近距离门 */
+static void Servo_Calibrate(void)
+{
+    g_servoCalibrating = 1;
+    Servo_CalRun();
+    g_servoCalibrating = 0;
 }
 
 /* 系统初始化 */
@@ -118,100 +1076,1790 @@ static void System_Init(void)
     led_init();
     key_init();
     sr04_init();
+    Sr04Async_Init();
     sg90_init();
     oled_init();
-    Local_Beep_Init(); // 使用本地初始化，GPIO 7
+    Indicator_Init(); // 蜂鸣器 GPIO7 复用为 PWM0
 
     // 创建互斥锁
     osMutexAttr_t mutex_attr = {0};
     g_systemMutex = osMutexNew(&mutex_attr);
+    g_frameMutex = osMutexNew(&mutex_attr);
+    g_servoMutex = osMutexNew(&mutex_attr);
 
-    // 创建消息队列
-    g_dataQueue = osMessageQueueNew(1, sizeof(RadarData_t), NULL);
+    // 告警事件 (回波中断与扫描任务置位，告警任务等待)
+    g_alarmEvent = osEventFlagsNew(NULL);
+
+    // OLED 传输事件 (开始时前台缓冲空闲)
+    g_oledEvent = osEventFlagsNew(NULL);
+    osEventFlagsSet(g_oledEvent, OLED_EVT_IDLE);
+
+    // 扫描帧邮箱 (显示任务的当前角度与距离直接读状态快照，不另设队列)
+    for (int i = 0; i < FRAME_CONSUMER_COUNT; i++)
+        g_frameConsumers[i].mailbox = osMessageQueueNew(FRAME_MAILBOX_DEPTH, sizeof(RadarFrame_t *), NULL);
 
     printf("超声波雷达系统初始化完成\n");
 }
 
-/* 告警控制 */
-static void Alarm_Control(AlarmState_t state)
+/* 告警控制：按告警等级设置指示图案。警告时 LED 闪烁周期随最短碰撞时间缩短，
+ * 危险时常亮并持续鸣叫；节拍由指示输出引擎执行，这里不需要周期调用 */
+static void Alarm_Control(AlarmState_t state)
+{
+    IndicatorPattern_t p = {0};
+
+    switch (state)
+    {
+    case ALARM_SAFE:
+        break;
+    case ALARM_WARNING:
+        {
+            uint32_t ttc = g_trackTtcMs;
+            if (ttc < TTC_ALARM_MS)
+                ttc = TTC_ALARM_MS;
+            if (ttc > TTC_WARNING_MS)
+                ttc = TTC_WARNING_MS;
+            uint32_t period = IND_WARN_FAST_MS + (ttc - TTC_ALARM_MS) * (IND_WARN_SLOW_MS - IND_WARN_FAST_MS) /
+                                                     (TTC_WARNING_MS - TTC_ALARM_MS);
+            period = period / IND_WARN_STEP_MS * IND_WARN_STEP_MS;
+            p.ledPeriodMs = (uint16_t)period;
+            p.ledOnMs = (uint16_t)(period / 2);
+        }
+        break;
+    case ALARM_DANGER:
+        p.ledOnMs = 1;
+        p.beepOnMs = 1;
+        p.toneHz = IND_TONE_HZ;
+        break;
+    }
+    Indicator_Set(&p);
+}
+
+/* 告警状态判定 */
+static AlarmState_t Get_AlarmState(int32_t rangeMm)
+{
+    if (rangeMm > 0 && rangeMm <= ALARM_DISTANCE_MM)
+        return ALARM_DANGER;
+    // 距离阈值之外由跟踪器按碰撞时间决定：静止的近处墙面不告警，快速逼近的目标提前告警
+    return g_trackAlarm;
+}
+
+/* ============================================================
+ * 系统状态快照 (顺序锁)
+ * 写者之间用 g_systemMutex 串行，写入前后各递增一次序号；读者不加锁，
+ * 读到奇数序号或前后序号不一致时重读。按键、MQTT 回调 (网络服务线程) 和整帧上报任务
+ * 读取状态时不再与扫描任务争用互斥锁。
+ * ============================================================ */
+
+/* 写者加锁，统计争用次数与等待时间 (拿到锁之后才计数，计数本身受锁保护) */
+static void State_Lock(void)
+{
+    if (osMutexAcquire(g_systemMutex, 0) != osOK)
+    {
+        uint32_t t0 = hi_get_us();
+        osMutexAcquire(g_systemMutex, osWaitForever);
+        uint32_t wait = hi_get_us() - t0;
+        g_stateLockStats.contended++;
+        g_stateLockStats.waitUs += wait;
+        if (wait > g_stateLockStats.maxWaitUs)
+            g_stateLockStats.maxWaitUs = wait;
+    }
+    g_stateLockStats.acquires++;
+}
+
+static void State_Unlock(void)
+{
+    osMutexRelease(g_systemMutex);
+}
+
+/* 发布新状态 (调用者须持有 State_Lock) */
+static void State_Publish(const RadarState_t *next)
+{
+    g_stateSeq++;
+    __sync_synchronize();
+    g_state = *next;
+    __sync_synchronize();
+    g_stateSeq++;
+}
+
+/* 读取一致的状态快照，不阻塞写者；返回快照对应的序号 (状态每发布一次加 2) */
+static uint32_t State_Read(RadarState_t *out)
+{
+    while (1)
+    {
+        uint32_t seq = g_stateSeq;
+        if (seq & 1)
+        {
+            // 写者被抢占在临界区内，让出 CPU 使其完成
+            __sync_fetch_and_add(&g_stateLockStats.readRetries, 1);
+            osDelay(1);
+            continue;
+        }
+        __sync_synchronize();
+        *out = g_state;
+        __sync_synchronize();
+        if (g_stateSeq == seq)
+            return seq;
+        __sync_fetch_and_add(&g_stateLockStats.readRetries, 1);
+    }
+}
+
+/* 启停扫描，状态改变返回 1 */
+static uint8_t State_SetScanEnabled(uint8_t enable)
+{
+    State_Lock();
+    uint8_t changed = (g_state.scanEnabled != enable);
+    if (changed)
+    {
+        RadarState_t next = g_state;
+        next.scanEnabled = enable;
+        next.sysState = enable ? SYSTEM_SCANNING : SYSTEM_STOPPED;
+        State_Publish(&next);
+    }
+    State_Unlock();
+    if (changed)
+        osEventFlagsSet(g_alarmEvent, ALARM_EVT_STATE); // 停止后立即撤掉告警输出
+    if (changed && !enable)
+        Servo_Move(90); // 复位到中间
+    return changed;
+}
+
+/* ============================================================
+ * 角度分区滤波器组
+ * 每个扫描角度独立维护滤波状态，避免不同方向的目标互相串扰；
+ * 单次更新耗时与窗口长度有关但有固定上限，不影响扫描节拍。
+ * ============================================================ */
+
+/* 角度转分区下标 */
+static int Filter_BinIndex(uint16_t angle)
+{
+    if (angle <= SCAN_START_ANGLE)
+        return 0;
+    int idx = (angle - SCAN_START_ANGLE + SCAN_STEP_ANGLE / 2) / SCAN_STEP_ANGLE;
+    return idx >= RADAR_BIN_COUNT ? RADAR_BIN_COUNT - 1 : idx;
+}
+
+/* 清空全部分区 (切换滤波模式时调用) */
+static void Filter_Reset(void)
+{
+    memset(g_binFilter, 0, sizeof(g_binFilter));
+}
+
+/* 中值：窗口复制后插入排序，N 不超过 7 */
+static int32_t Filter_Median(BinFilter_t *bin, int32_t zMm)
+{
+    uint16_t sorted[FILTER_MEDIAN_N];
+    bin->window[bin->head] = (uint16_t)zMm;
+    bin->head = (bin->head + 1) % FILTER_MEDIAN_N;
+    if (bin->count < FILTER_MEDIAN_N)
+        bin->count++;
+
+    for (uint8_t i = 0; i < bin->count; i++)
+    {
+        uint16_t v = bin->window[i];
+        int8_t j = (int8_t)i - 1;
+        while (j >= 0 && sorted[j] > v)
+        {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    return sorted[bin->count / 2];
+}
+
+/* α-β：预测 + 残差修正，超门限的单次读数视为毛刺。
+ * 全部为 32 位整数运算：距离 mm、速度 mm/s、增益 Q16，dt 按 ms 计 (上限 5 s 保证不溢出) */
+static int32_t Filter_AlphaBeta(BinFilter_t *bin, int32_t zMm, uint32_t nowUs)
+{
+    if (bin->rangeMm <= 0)
+    {
+        bin->rangeMm = zMm;
+        bin->rateMmS = 0;
+        bin->rejects = 0;
+        return zMm;
+    }
+    int32_t dtMs = (int32_t)((nowUs - bin->lastUs) / 1000);
+    if (dtMs > 5000)
+        dtMs = 5000;
+    int32_t predicted = bin->rangeMm + bin->rateMmS * dtMs / 1000;
+    int32_t residual = zMm - predicted;
+    if (residual > FILTER_GATE_MM || residual < -FILTER_GATE_MM)
+    {
+        if (++bin->rejects < FILTER_REJECT_LIMIT)
+            return bin->rangeMm;
+        bin->rangeMm = zMm;
+        bin->rateMmS = 0;
+        bin->rejects = 0;
+        return zMm;
+    }
+    bin->rejects = 0;
+    bin->rangeMm = predicted + residual * FILTER_ALPHA_Q16 / 65536;
+    if (dtMs > 0)
+        bin->rateMmS += residual * (FILTER_BETA_Q16 / 16) * 1000 / 4096 / dtMs; // 增益先缩 16 倍，残差在门限内不溢出
+    return bin->rangeMm;
+}
+
+/* 更新某个角度的滤波器，返回该角度的滤波距离 (mm，0 表示无目标) */
+static int32_t Filter_Update(uint16_t angle, int32_t rawMm)
+{
+    BinFilter_t *bin = &g_binFilter[Filter_BinIndex(angle)];
+    uint32_t nowUs = hi_get_us();
+
+    // 无回波或超出量程：连续多次才清空，单次丢波保持原值
+    if (rawMm <= 0 || rawMm >= RADAR_MAX_RANGE_MM)
+    {
+        if (++bin->misses >= FILTER_MISS_LIMIT)
+        {
+            memset(bin, 0, sizeof(*bin));
+        }
+        return bin->rangeMm;
+    }
+    bin->misses = 0;
+
+    if (g_filterMode == FILTER_ALPHA_BETA)
+        Filter_AlphaBeta(bin, rawMm, nowUs);
+    else
+        bin->rangeMm = Filter_Median(bin, rawMm);
+    bin->lastUs = nowUs;
+    return bin->rangeMm;
+}
+
+/* ============================================================
+ * OLED 雷达图几何表
+ * g_geoPoint[角度][像素半径] 直接给出屏幕坐标，扫描线终点即最外一圈。
+ * 表由整数常量表达式在编译期展开 (约 16 KB，放在 Flash)，正弦用 Bhaskara 近似：
+ * sin(x°) ≈ 4x(180-x) / (40500 - x(180-x))，误差 < 0.2%，45 像素半径内不到 0.1 像素。
+ * ============================================================ */
+#define GEO_Q 16384
+#define GEO_SIN_Q(a) (4 * (a) * (180 - (a)) * GEO_Q / (40500 - (a) * (180 - (a))))
+#define GEO_COS_Q(a) ((a) <= 90 ? GEO_SIN_Q(90 - (a)) : -GEO_SIN_Q((a) - 90))
+#define GEO_ROUND_Q(v) (((v) + ((v) >= 0 ? GEO_Q / 2 : -GEO_Q / 2)) / GEO_Q)
+#define GEO_PT(a, r) {(uint8_t)(GEO_CX + GEO_ROUND_Q((r) * GEO_COS_Q(a))), (uint8_t)(GEO_CY - GEO_ROUND_Q((r) * GEO_SIN_Q(a)))}
+#define GEO_R5(a, r) GEO_PT(a, r), GEO_PT(a, r + 1), GEO_PT(a, r + 2), GEO_PT(a, r + 3), GEO_PT(a, r + 4)
+#define GEO_ROW(a)                                                                                                   \
+    {GEO_R5(a, 0), GEO_R5(a, 5), GEO_R5(a, 10), GEO_R5(a, 15), GEO_R5(a, 20),                                        \
+     GEO_R5(a, 25), GEO_R5(a, 30), GEO_R5(a, 35), GEO_R5(a, 40), GEO_PT(a, 45)}
+#define GEO_A5(a) GEO_ROW(a), GEO_ROW(a + 1), GEO_ROW(a + 2), GEO_ROW(a + 3), GEO_ROW(a + 4)
+
+static const GeoPoint_t g_geoPoint[GEO_ANGLES][GEO_RADIUS_PX + 1] = {
+    GEO_A5(0),   GEO_A5(5),   GEO_A5(10),  GEO_A5(15),  GEO_A5(20),  GEO_A5(25),  GEO_A5(30),  GEO_A5(35),
+    GEO_A5(40),  GEO_A5(45),  GEO_A5(50),  GEO_A5(55),  GEO_A5(60),  GEO_A5(65),  GEO_A5(70),  GEO_A5(75),
+    GEO_A5(80),  GEO_A5(85),  GEO_A5(90),  GEO_A5(95),  GEO_A5(100), GEO_A5(105), GEO_A5(110), GEO_A5(115),
+    GEO_A5(120), GEO_A5(125), GEO_A5(130), GEO_A5(135), GEO_A5(140), GEO_A5(145), GEO_A5(150), GEO_A5(155),
+    GEO_A5(160), GEO_A5(165), GEO_A5(170), GEO_A5(175), GEO_ROW(180)};
+
+/* 某个角度的一条射线 (下标为像素半径) */
+static const GeoPoint_t *Geo_Ray(int angle)
+{
+    if (angle < 0)
+        angle = 0;
+    if (angle >= GEO_ANGLES)
+        angle = GEO_ANGLES - 1;
+    return g_geoPoint[angle];
+}
+
+/* 距离 (mm) 对应的像素半径，超出满量程返回 -1 */
+static int Geo_RadiusPx(uint32_t rangeMm)
+{
+    if (rangeMm == 0 || rangeMm >= DISPLAY_RANGE_CM * 10)
+        return -1;
+    return (int)(rangeMm * GEO_RADIUS_PX / (DISPLAY_RANGE_CM * 10));
+}
+
+/* 打印 OLED 绘制耗时、刷新量与实际帧率 */
+static void Render_PrintStats(void)
+{
+    const RenderStats_t *rs = &g_renderStats;
+    if (rs->frames == 0)
+        return;
+    uint32_t spanMs = rs->lastMs - rs->firstMs;
+    printf("[OLED] %u frames, %u.%u fps, draw avg %u cyc (max %u), flush avg %u B (max %u), %u us, swap wait %u us\n",
+           rs->frames, spanMs ? (rs->frames - 1) * 1000 / spanMs : 0,
+           spanMs ? (rs->frames - 1) * 10000 / spanMs % 10 : 0, (uint32_t)(rs->drawCycles / rs->frames),
+           rs->drawCyclesMax, (uint32_t)(rs->bytes / rs->frames), rs->bytesMax,
+           (uint32_t)(rs->refreshUs / rs->frames), (uint32_t)(rs->swapWaitUs / rs->frames));
+}
+
+/* ============================================================
+ * 测距流水线基准
+ * Hi3861 的 RISC-V 内核没有浮点单元，浮点乘除和比较都是软件库调用。
+ * 用同一串模拟回波分别跑原浮点实现 (cm 浮点 + 0.034f/2 换算) 与定点实现
+ * (整数 mm + Q16 增益)，计 CPU 周期并比较两者输出差。
+ * ============================================================ */
+
+/* 读 CPU 周期计数 */
+static inline uint32_t Bench_Cycles(void)
+{
+#if defined(__riscv)
+    uint32_t c;
+    __asm__ volatile("csrr %0, mcycle" : "=r"(c));
+    return c;
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__builtin_ia32_rdtsc();
+#else
+    return hi_get_us();
+#endif
+}
+
+#if RADAR_BENCH
+/* 原浮点中值滤波 */
+static float Bench_FloatMedian(BenchFloatBin_t *bin, float z)
+{
+    float sorted[FILTER_MEDIAN_N];
+    bin->window[bin->head] = z;
+    bin->head = (bin->head + 1) % FILTER_MEDIAN_N;
+    if (bin->count < FILTER_MEDIAN_N)
+        bin->count++;
+    for (uint8_t i = 0; i < bin->count; i++)
+    {
+        float v = bin->window[i];
+        int8_t j = (int8_t)i - 1;
+        while (j >= 0 && sorted[j] > v)
+        {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    return sorted[bin->count / 2];
+}
+
+/* 原浮点 α-β 滤波 */
+static float Bench_FloatAlphaBeta(BenchFloatBin_t *bin, float z, uint32_t nowUs)
+{
+    if (bin->range <= 0)
+    {
+        bin->range = z;
+        bin->rate = 0;
+        bin->rejects = 0;
+        return z;
+    }
+    float dt = (float)(nowUs - bin->lastUs) / 1000000.0f;
+    if (dt > 5.0f)
+        dt = 5.0f;
+    float predicted = bin->range + bin->rate * dt;
+    float residual = z - predicted;
+    if (residual > FILTER_GATE_MM / 10 || residual < -FILTER_GATE_MM / 10)
+    {
+        if (++bin->rejects < FILTER_REJECT_LIMIT)
+            return bin->range;
+        bin->range = z;
+        bin->rate = 0;
+        bin->rejects = 0;
+        return z;
+    }
+    bin->rejects = 0;
+    bin->range = predicted + FILTER_ALPHA_Q16 / 65536.0f * residual;
+    if (dt > 0.001f)
+        bin->rate += FILTER_BETA_Q16 / 65536.0f * residual / dt;
+    return bin->range;
+}
+
+/* 第 i 个模拟回波脉宽：缓慢逼近的目标 + 噪声 + 偶发毛刺 */
+static uint32_t Bench_EchoUs(uint32_t i, uint32_t *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    uint32_t us = 8000 - (i % 400) * 15 + (*seed >> 16) % 60;
+    if (((*seed >> 8) & 0x3F) == 0)
+        us = 1000 + (*seed >> 20) % 10000;
+    return us;
+}
+
+/* 一种滤波模式下两条流水线各跑 BENCH_SAMPLES 个样本 (换算 + 滤波 + 告警判定 + 写帧取整) */
+static void Bench_RunMode(FilterMode_t mode)
+{
+    volatile uint32_t sink = 0;
+    uint32_t seed = 1;
+    uint32_t nowUs = 0;
+    BenchFloatBin_t fbin = {0};
+    uint32_t t0 = Bench_Cycles();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        float cm = (float)Bench_EchoUs(i, &seed) * 0.034f / 2;
+        nowUs += 40000;
+        float out = (mode == FILTER_ALPHA_BETA) ? Bench_FloatAlphaBeta(&fbin, cm, nowUs) : Bench_FloatMedian(&fbin, cm);
+        fbin.lastUs = nowUs;
+        uint16_t mm = (uint16_t)(out * 10.0f + 0.5f);
+        sink += mm + (out > 0 && out <= ALARM_DISTANCE_CM);
+    }
+    uint32_t floatCycles = Bench_Cycles() - t0;
+
+    seed = 1;
+    nowUs = 0;
+    BinFilter_t ibin = {0};
+    t0 = Bench_Cycles();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        int32_t zMm = (int32_t)SR04_US_TO_MM(Bench_EchoUs(i, &seed));
+        nowUs += 40000;
+        int32_t out = (mode == FILTER_ALPHA_BETA) ? Filter_AlphaBeta(&ibin, zMm, nowUs) : Filter_Median(&ibin, zMm);
+        ibin.lastUs = nowUs;
+        sink += (uint16_t)out + (out > 0 && out <= ALARM_DISTANCE_MM);
+    }
+    uint32_t fixedCycles = Bench_Cycles() - t0;
+
+    // 精度：重放两条流水线比较输出 (不计时)
+    uint32_t maxErr = 0;
+    seed = 1;
+    nowUs = 0;
+    memset(&fbin, 0, sizeof(fbin));
+    memset(&ibin, 0, sizeof(ibin));
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        uint32_t us = Bench_EchoUs(i, &seed);
+        nowUs += 40000;
+        float fo = (mode == FILTER_ALPHA_BETA) ? Bench_FloatAlphaBeta(&fbin, (float)us * 0.034f / 2, nowUs)
+                                               : Bench_FloatMedian(&fbin, (float)us * 0.034f / 2);
+        int32_t io = (mode == FILTER_ALPHA_BETA) ? Filter_AlphaBeta(&ibin, (int32_t)SR04_US_TO_MM(us), nowUs)
+                                                 : Filter_Median(&ibin, (int32_t)SR04_US_TO_MM(us));
+        fbin.lastUs = ibin.lastUs = nowUs;
+        int32_t err = io - (int32_t)(fo * 10.0f + 0.5f);
+        if (err < 0)
+            err = -err;
+        if ((uint32_t)err > maxErr)
+            maxErr = (uint32_t)err;
+    }
+    (void)sink;
+
+    g_benchResult.samples = BENCH_SAMPLES;
+    g_benchResult.floatCycles[mode] = floatCycles;
+    g_benchResult.fixedCycles[mode] = fixedCycles;
+    g_benchResult.maxErrMm[mode] = maxErr;
+}
+
+/* 原 5° 粒度浮点正弦表 (仅供基准对比) */
+static float Bench_FloatSin(int angle)
+{
+    static const float sinVal[] = {0.0000f, 0.0872f, 0.1736f, 0.2588f, 0.3420f, 0.4226f, 0.5000f,
+                                   0.5736f, 0.6428f, 0.7071f, 0.7660f, 0.8192f, 0.8660f, 0.9063f,
+                                   0.9397f, 0.9659f, 0.9848f, 0.9962f, 1.0000f};
+    if (angle < 0)
+        angle = 0;
+    if (angle > 180)
+        angle = 180;
+    if (angle > 90)
+        angle = 180 - angle;
+    return sinVal[(angle + 2) / 5];
+}
+
+static float Bench_FloatCos(int angle)
+{
+    return angle <= 90 ? Bench_FloatSin(90 - angle) : -Bench_FloatSin(angle - 90);
+}
+
+/* 雷达图一帧的坐标计算 (扫描线终点 + 全部角度的历史点 + 当前点)，
+ * 原浮点正弦/乘法与几何表各跑 BENCH_SAMPLES / 10 帧，不含画点本身 */
+static void Bench_Geometry(void)
+{
+    volatile uint32_t sink = 0;
+    uint32_t frames = BENCH_SAMPLES / 10;
+    uint32_t t0 = Bench_Cycles();
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        int angle = (int)(f * 7 % 181);
+        float c = Bench_FloatCos(angle), sn = Bench_FloatSin(angle);
+        sink += (uint32_t)(64 + (int)(45 * c)) + (uint32_t)(63 - (int)(45 * sn));
+        for (int i = 0; i < RADAR_FRAME_BINS; i++)
+        {
+            int h = SCAN_START_ANGLE + i * RADAR_ANGLE_RES_DEG;
+            int r = (int)((f * 13 + i * 29) % (DISPLAY_RANGE_CM * 10)) * 45 / (DISPLAY_RANGE_CM * 10);
+            sink += (uint32_t)(64 + (int)(r * Bench_FloatCos(h))) + (uint32_t)(63 - (int)(r * Bench_FloatSin(h)));
+        }
+    }
+    g_benchResult.geoFloatCycles = Bench_Cycles() - t0;
+
+    t0 = Bench_Cycles();
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        const GeoPoint_t *ray = Geo_Ray((int)(f * 7 % 181));
+        sink += ray[GEO_RADIUS_PX].x + ray[GEO_RADIUS_PX].y;
+        for (int i = 0; i < RADAR_FRAME_BINS; i++)
+        {
+            int r = Geo_RadiusPx((f * 13 + i * 29) % (DISPLAY_RANGE_CM * 10));
+            if (r >= 0)
+            {
+                const GeoPoint_t *p = &Geo_Ray(SCAN_START_ANGLE + i * RADAR_ANGLE_RES_DEG)[r];
+                sink += p->x + p->y;
+            }
+        }
+    }
+    g_benchResult.geoTableCycles = Bench_Cycles() - t0;
+    g_benchResult.geoFrames = frames;
+    (void)sink;
+}
+
+/* 跑基准并打印每个样本的平均周期 */
+static void Bench_Run(void)
+{
+    static const char *const names[] = {"median", "alpha-beta"};
+    Bench_RunMode(FILTER_MEDIAN);
+    Bench_RunMode(FILTER_ALPHA_BETA);
+    Bench_Geometry();
+    for (int m = 0; m < 2; m++)
+    {
+        printf("[Bench] %-10s float %u cyc/sample, fixed %u cyc/sample, max diff %u mm\n", names[m],
+               g_benchResult.floatCycles[m] / BENCH_SAMPLES, g_benchResult.fixedCycles[m] / BENCH_SAMPLES,
+               g_benchResult.maxErrMm[m]);
+    }
+    printf("[Bench] oled geom  float %u cyc/frame, table %u cyc/frame\n",
+           g_benchResult.geoFloatCycles / g_benchResult.geoFrames, g_benchResult.geoTableCycles / g_benchResult.geoFrames);
+}
+#endif
+
+/* ============================================================
+ * OLED 显示层 (双缓冲 + 脏区刷新)
+ * 显示任务只画后台缓冲并记下每页的脏列范围，画完 Oled_Swap() 把它换到前台，
+ * 由低优先级的传输任务异步刷屏，完成后置 OLED_EVT_IDLE；下一帧的绘制与
+ * 本帧的 I2C 传输重叠进行，刷屏期间不持有任何应用锁。
+ * Oled_Flush() 把前台的脏范围与面板当前内容逐字节比对，只把变化的列段发出去。
+ * bsp_oled 只用来初始化、清屏和 oled_wr_byte()：它的 oled_showstring()/oled_drawline() 画在
+ * 驱动内部的显存里，oled_refresh_gram() 每次整屏发送，且不公开显存，无法只发变化的字节，
+ * 所以文字、直线与打点都在这里的帧缓冲上重新实现。
+ * 与原界面的可见差别：文字改用下面自带的 5x7 点阵 (8x16 字格由它纵向放大两倍得到)，
+ * 不再是 bsp_oled 的 8x16 ASCII 字库，标题栏与提示的字形更方、笔画为 2 像素高；
+ * 直线 (Bresenham) 与 3x3 大点也是自行绘制，与 bsp_oled 画出的可能有个别像素不同。
+ * ============================================================ */
+
+// 5x7 点阵 (只含界面用到的字符)，每字 5 列，列内低位在上
+static const char g_fontChars[] = " -.:^0123456789ACDEFILMNOPRSTWacdeilm";
+static const uint8_t g_font5x7[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+    {0x00, 0x36, 0x36, 0x00, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, {0x3E, 0x51, 0x49, 0x45, 0x3E},
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31},
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30},
+    {0x01, 0x71, 0x09, 0x05, 0x03}, {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E},
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x3E, 0x41, 0x41, 0x41, 0x22}, {0x7F, 0x41, 0x41, 0x22, 0x1C},
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F},
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x38, 0x40, 0x3F},
+    {0x20, 0x54, 0x54, 0x54, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00},
+    {0x7C, 0x04, 0x18, 0x04, 0x78}};
+
+/* 标记某页 [x0, x1] 列需要比对 */
+static void Oled_MarkDirty(int page, int x0, int x1)
+{
+    if (x0 < g_oledDirtyLo[page])
+        g_oledDirtyLo[page] = (uint8_t)x0;
+    if (x1 > g_oledDirtyHi[page])
+        g_oledDirtyHi[page] = (uint8_t)x1;
+}
+
+/* 清空帧缓冲与面板 (显示任务启动时、传输任务开始工作前调用一次) */
+static void Oled_Init(void)
+{
+    memset(g_oledBuf, 0, sizeof(g_oledBuf));
+    memset(g_oledPanel, 0, sizeof(g_oledPanel));
+    memset(g_oledDirtyLo, OLED_WIDTH, sizeof(g_oledDirtyLo));
+    memset(g_oledDirtyHi, 0, sizeof(g_oledDirtyHi));
+    oled_clear();
+    oled_refresh_gram();
+}
+
+static void Oled_Point(int x, int y, uint8_t on)
+{
+    if (x < 0 || x >= OLED_WIDTH || y < 0 || y >= OLED_PAGES * 8)
+        return;
+    if (on)
+        g_oledFb[y / 8][x] |= (uint8_t)(1u << (y % 8));
+    else
+        g_oledFb[y / 8][x] &= (uint8_t)~(1u << (y % 8));
+    Oled_MarkDirty(y / 8, x, x);
+}
+
+/* 3x3 的点 */
+static void Oled_BigPoint(int x, int y, uint8_t on)
+{
+    for (int dx = -1; dx <= 1; dx++)
+        for (int dy = -1; dy <= 1; dy++)
+            Oled_Point(x + dx, y + dy, on);
+}
+
+/* Bresenham 直线 */
+static void Oled_Line(int x1, int y1, int x2, int y2, uint8_t on)
+{
+    int dx = x2 > x1 ? x2 - x1 : x1 - x2, sx = x1 < x2 ? 1 : -1;
+    int dy = y2 > y1 ? y1 - y2 : y2 - y1, sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    while (1)
+    {
+        Oled_Point(x1, y1, on);
+        if (x1 == x2 && y1 == y2)
+            break;
+        int e2 = 2 * err;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x1 += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
+
+/* 查字模，字库里没有的字符显示为空格 */
+static const uint8_t *Oled_Glyph(char c)
+{
+    for (int i = 0; g_fontChars[i] != '\0'; i++)
+    {
+        if (g_fontChars[i] == c)
+            return g_font5x7[i];
+    }
+    return g_font5x7[0];
+}
+
+/* 一个 8x16 字格的上下两页列字节 (5x7 字模纵向放大两倍，左右各留一列) */
+static void Oled_TallCell(char c, uint8_t top[8], uint8_t bottom[8])
+{
+    const uint8_t *g = Oled_Glyph(c);
+    for (int col = 0; col < 8; col++)
+    {
+        uint8_t bits = (col >= 1 && col <= 5) ? g[col - 1] : 0;
+        uint16_t tall = 0;
+        for (int b = 0; b < 7; b++)
+        {
+            if (bits & (1u << b))
+                tall |= (uint16_t)(3u << (2 * b + 1));
+        }
+        top[col] = (uint8_t)tall;
+        bottom[col] = (uint8_t)(tall >> 8);
+    }
+}
+
+/* 文本，y 须按页对齐。size 16: 8x16 字格；size 8: 6x8 字格 */
+static void Oled_Text(int x, int y, const char *str, uint8_t size)
+{
+    int page = y / 8;
+    int cell = (size == 16) ? 8 : 6;
+    for (; *str != '\0' && x + cell <= OLED_WIDTH; str++, x += cell)
+    {
+        if (size == 16)
+        {
+            Oled_TallCell(*str, &g_oledFb[page][x], &g_oledFb[page + 1][x]);
+            Oled_MarkDirty(page + 1, x, x + cell - 1);
+        }
+        else
+        {
+            const uint8_t *g = Oled_Glyph(*str);
+            for (int col = 0; col < cell; col++)
+                g_oledFb[page][x + col] = col < 5 ? g[col] : 0;
+        }
+        Oled_MarkDirty(page, x, x + cell - 1);
+    }
+}
+
+/* 把前台缓冲中变化的列段发到面板，返回发送的字节数 (含寻址命令)。仅传输任务调用 */
+static uint32_t Oled_Flush(void)
+{
+    uint32_t sent = 0;
+    for (int page = 0; page < OLED_PAGES; page++)
+    {
+        int lo = g_oledTxLo[page];
+        int hi = g_oledTxHi[page];
+        const uint8_t *fb = g_oledFront[page];
+        uint8_t *panel = g_oledPanel[page];
+        for (int x = lo; x <= hi; x++)
+        {
+            if (fb[x] == panel[x])
+                continue;
+            // 一段：向后延伸，直到连续 OLED_FLUSH_GAP 个字节都没变
+            int end = x;
+            for (int k = x + 1, same = 0; k <= hi && same < OLED_FLUSH_GAP; k++)
+            {
+                if (fb[k] != panel[k])
+                {
+                    end = k;
+                    same = 0;
+                }
+                else
+                {
+                    same++;
+                }
+            }
+            oled_wr_byte((uint8_t)(0xB0 + page), OLED_CMD);
+            oled_wr_byte((uint8_t)(x & 0x0F), OLED_CMD);
+            oled_wr_byte((uint8_t)(0x10 | (x >> 4)), OLED_CMD);
+            for (int k = x; k <= end; k++)
+            {
+                oled_wr_byte(fb[k], OLED_DATA);
+                panel[k] = fb[k];
+            }
+            sent += 3 + (uint32_t)(end - x + 1);
+            x = end;
+        }
+    }
+    return sent;
+}
+
+/* 传输任务：等前台缓冲交过来，刷屏后通知显示任务可以再次交换 */
+static void Oled_TxTask(void *arg)
+{
+    (void)arg;
+    while (1)
+    {
+        osEventFlagsWait(g_oledEvent, OLED_EVT_KICK, osFlagsWaitAny, osWaitForever);
+        uint32_t start = hi_get_us();
+        g_oledTxStats.bytes = Oled_Flush();
+        g_oledTxStats.refreshUs = hi_get_us() - start;
+        osEventFlagsSet(g_oledEvent, OLED_EVT_IDLE);
+    }
+}
+
+/* 交换前后台缓冲并启动传输，返回等上一帧传输完成的时间 (us)。
+ * 换回来的后台缓冲是上上帧的内容，整屏标脏，由下一帧整体重画。
+ * 上一帧传输已结束，传输任务的计数此时不会再变，在这里并入显示任务的统计 */
+static uint32_t Oled_Swap(void)
+{
+    uint32_t start = hi_get_us();
+    osEventFlagsWait(g_oledEvent, OLED_EVT_IDLE, osFlagsWaitAny, osWaitForever);
+    RenderStats_t *rs = &g_renderStats;
+    rs->refreshUs += g_oledTxStats.refreshUs;
+    rs->bytes += g_oledTxStats.bytes;
+    if (g_oledTxStats.bytes > rs->bytesMax)
+        rs->bytesMax = g_oledTxStats.bytes;
+    uint8_t(*drawn)[OLED_WIDTH] = g_oledFb;
+    g_oledFb = g_oledFront;
+    g_oledFront = drawn;
+    memcpy(g_oledTxLo, g_oledDirtyLo, sizeof(g_oledTxLo));
+    memcpy(g_oledTxHi, g_oledDirtyHi, sizeof(g_oledTxHi));
+    memset(g_oledDirtyLo, 0, sizeof(g_oledDirtyLo));
+    memset(g_oledDirtyHi, OLED_WIDTH - 1, sizeof(g_oledDirtyHi));
+    osEventFlagsSet(g_oledEvent, OLED_EVT_KICK);
+    return hi_get_us() - start;
+}
+
+/* 一帧画完：交换缓冲并累计绘制耗时 */
+static void Oled_EndFrame(uint32_t drawStartCycles)
+{
+    uint32_t drawCycles = Bench_Cycles() - drawStartCycles;
+    RenderStats_t *rs = &g_renderStats;
+    rs->swapWaitUs += Oled_Swap();
+    rs->drawCycles += drawCycles;
+    if (drawCycles > rs->drawCyclesMax)
+        rs->drawCyclesMax = drawCycles;
+    rs->lastMs = hi_get_milli_seconds();
+    if (rs->frames++ == 0)
+        rs->firstMs = rs->lastMs;
+}
+
+/* ============================================================
+ * OLED 帧合成
+ * 距离环、基线、方位刻度、量程标注和标题栏里不变的符号预先画进静态底图，
+ * 每帧先整块 memcpy 到帧缓冲，再贴状态字样、数字字格和扫描线/目标点。
+ * 字格在启动时由字模放大好，热路径上没有格式化也不查字模。
+ * ============================================================ */
+
+/* 预渲染静态底图与字格 (显示任务启动时调用一次，之后帧缓冲会被覆盖) */
+static void Compose_Build(void)
+{
+    char label[8];
+    memset(g_oledFb, 0, sizeof(g_oledStatic));
+
+    // 距离环：内环按固定点距打点，最外一环逐度连成实线
+    for (int ring = 1; ring <= OLED_RING_COUNT; ring++)
+    {
+        int r = GEO_RADIUS_PX * ring / OLED_RING_COUNT;
+        int step = (ring == OLED_RING_COUNT) ? 1 : OLED_RING_DOT_PX * 57 / r;
+        for (int a = 0; a < GEO_ANGLES; a += (step > 0 ? step : 1))
+            Oled_Point(Geo_Ray(a)[r].x, Geo_Ray(a)[r].y, 1);
+    }
+    // 基线与方位刻度
+    Oled_Line(GEO_CX - GEO_RADIUS_PX, GEO_CY, GEO_CX + GEO_RADIUS_PX, GEO_CY, 1);
+    for (int a = 0; a < GEO_ANGLES; a += OLED_TICK_DEG)
+    {
+        const GeoPoint_t *ray = Geo_Ray(a);
+        for (int r = GEO_RADIUS_PX - OLED_TICK_PX; r <= GEO_RADIUS_PX; r++)
+            Oled_Point(ray[r].x, ray[r].y, 1);
+    }
+    // 量程标注 (左上角空白处) 与标题栏固定符号
+    snprintf(label, sizeof(label), "%d", DISPLAY_RANGE_CM);
+    Oled_Text(0, 16, label, 8);
+    Oled_Text(0, 24, "cm", 8);
+    Oled_Text(OLED_RANGE_X - 8, 0, "^", 16);
+    Oled_Text(OLED_RANGE_X + 24, 0, "cm", 16);
+    memcpy(g_oledStatic, g_oledFb, sizeof(g_oledStatic));
+
+    // 网络故障提示：画在静态底图之外，单独存一块
+    Oled_Text(OLED_NOTICE_X, 16, "WiFi", 8);
+    Oled_Text(OLED_NOTICE_X, 24, "Fail", 8);
+    memcpy(g_oledNotice[0], &g_oledFb[2][OLED_NOTICE_X], sizeof(g_oledNotice[0]));
+    memcpy(g_oledNotice[1], &g_oledFb[3][OLED_NOTICE_X], sizeof(g_oledNotice[1]));
+
+    // 数字字格 (下标 10 为空格) 与状态字样
+    for (int d = 0; d < 11; d++)
+        Oled_TallCell(d < 10 ? (char)('0' + d) : ' ', g_oledDigit[d][0], g_oledDigit[d][1]);
+    for (int st = 0; st < OLED_STATUS_COUNT; st++)
+    {
+        for (int i = 0; i < 5; i++)
+            Oled_TallCell(g_oledStatusText[st][i], &g_oledStatus[st][0][i * 8], &g_oledStatus[st][1][i * 8]);
+    }
+}
+
+/* 新的一帧：整块贴静态底图，全屏交给 Oled_Flush 比对 */
+static void Compose_Begin(void)
+{
+    memcpy(g_oledFb, g_oledStatic, sizeof(g_oledStatic));
+    memset(g_oledDirtyLo, 0, sizeof(g_oledDirtyLo));
+    memset(g_oledDirtyHi, OLED_WIDTH - 1, sizeof(g_oledDirtyHi));
+}
+
+/* 贴一块两页高的预渲染字格 */
+static void Compose_BlitTall(int x, const uint8_t *top, const uint8_t *bottom, int width)
+{
+    memcpy(&g_oledFb[0][x], top, (size_t)width);
+    memcpy(&g_oledFb[1][x], bottom, (size_t)width);
+    Oled_MarkDirty(0, x, x + width - 1);
+    Oled_MarkDirty(1, x, x + width - 1);
+}
+
+/* 标题栏状态字样 */
+static void Compose_Status(OledStatus_t st)
+{
+    Compose_BlitTall(0, g_oledStatus[st][0], g_oledStatus[st][1], 40);
+}
+
+/* 标题栏数字：左对齐、空格补足 width 位，超出位数时显示全 9 */
+static void Compose_Number(int x, uint32_t value, int width)
+{
+    uint8_t digits[10];
+    uint32_t limit = 1;
+    int n = 0;
+    for (int i = 0; i < width; i++)
+        limit *= 10;
+    if (value >= limit)
+        value = limit - 1;
+    do
+    {
+        digits[n++] = (uint8_t)(value % 10);
+        value /= 10;
+    } while (value != 0);
+    for (int i = 0; i < width; i++)
+    {
+        int d = (i < n) ? digits[n - 1 - i] : 10;
+        Compose_BlitTall(x + i * 8, g_oledDigit[d][0], g_oledDigit[d][1], 8);
+    }
+}
+
+/* 扫描线 (须在 Compose_Begin 之后)：直接沿几何表的射线逐像素点亮 (相邻半径的点至多差一个像素，连成实线) */
+static void Compose_Sweep(const GeoPoint_t *ray)
+{
+    for (int r = 0; r <= GEO_RADIUS_PX; r++)
+        g_oledFb[ray[r].y / 8][ray[r].x] |= (uint8_t)(1u << (ray[r].y % 8));
+}
+
+/* 网络故障提示 (须在 Compose_Begin 之后) */
+static void Compose_Notice(void)
+{
+    memcpy(&g_oledFb[2][OLED_NOTICE_X], g_oledNotice[0], sizeof(g_oledNotice[0]));
+    memcpy(&g_oledFb[3][OLED_NOTICE_X], g_oledNotice[1], sizeof(g_oledNotice[1]));
+}
+
+/* 合成一整帧：静态底图、标题栏、扫描线、上一完整扫描帧 (轨迹) 与当前样本 */
+static void Compose_Frame(const RadarState_t *data, const RadarFrame_t *frame, OledStatus_t status)
+{
+    Compose_Begin();
+    Compose_Status(status);
+    Compose_Number(OLED_ANGLE_X, data->angle, 3);
+    Compose_Number(OLED_RANGE_X, (data->rangeMm + 5) / 10, 3);
+    if (NetService_GetState() == NET_STATE_WIFI_FAILED)
+        Compose_Notice();
+
+    // 扫描线 (终点是射线最外一圈，半径 45 时不会越出雷达区)
+    const GeoPoint_t *ray = Geo_Ray(data->angle);
+    Compose_Sweep(ray);
+    for (int i = 0; frame != NULL && i < RADAR_FRAME_BINS; i++)
+    {
+        int r = Geo_RadiusPx(frame->rangeMm[i]);
+        if (r >= 0)
+        {
+            const GeoPoint_t *p = &Geo_Ray(SCAN_START_ANGLE + i * RADAR_ANGLE_RES_DEG)[r];
+            Oled_BigPoint(p->x, p->y, 1);
+        }
+    }
+    // 当前样本叠加在扫描线上
+    int r = Geo_RadiusPx(data->rangeMm);
+    if (r >= 0)
+        Oled_BigPoint(ray[r].x, ray[r].y, 1);
+}
+
+/* ============================================================
+ * 静态背景模型
+ * 每个角度保留 BG_MODES 个距离模式 (均值/方差/权重)，权重是落入该模式的样本比例，
+ * 无回波的样本也参与，所以空旷角度没有背景模式。读数落入权重足够的模式为背景，
+ * 否则为前景。路过的物体每次距离不同，积累不起权重；停下不动的物体
+ * 约 BG_WEIGHT_MIN_Q16 / BG_ALPHA_Q16 个样本后并入背景，离开后旧模式重新占优。
+ * ============================================================ */
+
+/* 用帧内下标 idx 处的原始读数 (mm) 更新背景，返回是否为前景 (禁用时全部视为前景)
+ * 整数实现：权重与更新率 Q16，均值 Q8；匹配用平方比较，不开方 */
+static uint8_t Bg_Update(int idx, int32_t rawMm)
+{
+    BgBin_t *b = &g_bgBins[idx];
+    uint8_t echo = rawMm > 0;
+    uint8_t learning = b->n < BG_LEARN_SAMPLES;
+
+    // 学习期等权平均，尽快收敛
+    uint32_t alpha = BG_ALPHA_Q16;
+    if (learning)
+    {
+        b->n++;
+        if (65536u / b->n > alpha)
+            alpha = 65536u / b->n;
+    }
+
+    // 找最接近的匹配模式
+    int match = -1;
+    uint32_t bestDiff2 = 0;
+    for (int k = 0; echo && k < BG_MODES; k++)
+    {
+        const BgMode_t *m = &b->mode[k];
+        if (m->weight == 0)
+            continue;
+        uint32_t gate2 = BG_K_SIGMA * BG_K_SIGMA * m->varMm2;
+        if (gate2 < BG_MIN_DELTA_MM * BG_MIN_DELTA_MM)
+            gate2 = BG_MIN_DELTA_MM * BG_MIN_DELTA_MM;
+        int32_t diff = rawMm - m->meanQ8 / 256;
+        uint32_t diff2 = (uint32_t)(diff * diff);
+        if (diff2 <= gate2 && (match < 0 || diff2 < bestDiff2))
+        {
+            match = k;
+            bestDiff2 = diff2;
+        }
+    }
+
+    uint8_t wasBackground = match >= 0 && b->mode[match].weight >= BG_WEIGHT_MIN_Q16;
+    for (int k = 0; k < BG_MODES; k++)
+    {
+        BgMode_t *m = &b->mode[k];
+        if (k == match)
+            m->weight += (uint32_t)((uint64_t)alpha * (65536u - m->weight) / 65536u);
+        else
+            m->weight -= (uint32_t)((uint64_t)alpha * m->weight / 65536u);
+    }
+
+    if (match >= 0)
+    {
+        BgMode_t *m = &b->mode[match];
+        // 模式自身的更新率 rho = alpha / weight (Q16)
+        uint32_t w8 = m->weight >> 8;
+        uint32_t rho = w8 ? (alpha << 8) / w8 : 65536u;
+        if (rho > 65536u)
+            rho = 65536u;
+        int32_t d = rawMm * 256 - m->meanQ8;
+        m->meanQ8 += (int32_t)((int64_t)rho * d / 65536);
+        int32_t dMm = d / 256;
+        int32_t dv = dMm * dMm - (int32_t)m->varMm2;
+        m->varMm2 = (uint32_t)((int32_t)m->varMm2 + (int32_t)((int64_t)rho * dv / 65536));
+        if (m->varMm2 < BG_SIGMA_MIN_MM * BG_SIGMA_MIN_MM)
+            m->varMm2 = BG_SIGMA_MIN_MM * BG_SIGMA_MIN_MM;
+        if (!learning && !wasBackground && m->weight >= BG_WEIGHT_MIN_Q16)
+            g_bgStats.absorbed++;
+    }
+    else if (echo)
+    {
+        // 没有匹配：替换权重最小的模式
+        BgMode_t *m = &b->mode[0];
+        for (int k = 1; k < BG_MODES; k++)
+        {
+            if (b->mode[k].weight < m->weight)
+                m = &b->mode[k];
+        }
+        m->meanQ8 = rawMm * 256;
+        m->varMm2 = BG_SIGMA_MIN_MM * BG_SIGMA_MIN_MM;
+        m->weight = alpha;
+    }
+
+    // 背景判定用更新前的权重：读数自身不能把自己变成背景
+    uint8_t fg = echo && (learning || !wasBackground);
+    b->fg = fg;
+    if (!learning)
+    {
+        g_bgStats.samples++;
+        g_bgStats.foreground += fg;
+    }
+    return g_bgEnabled ? fg : echo;
+}
+
+/* 清空背景，重新学习 */
+static void Bg_Reset(void)
+{
+    memset(g_bgBins, 0, sizeof(g_bgBins));
+}
+
+/* 帧内下标 idx 的最近一次读数是否为前景 */
+static uint8_t Bg_IsForeground(int idx)
+{
+    return !g_bgEnabled || g_bgBins[idx].fg;
+}
+
+/* 已学完的角度数 */
+static int Bg_LearnedBins(void)
+{
+    int n = 0;
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+        n += (g_bgBins[i].n >= BG_LEARN_SAMPLES);
+    return n;
+}
+
+/* 打印背景模型统计 */
+static void Bg_PrintStats(void)
+{
+    const BgStats_t *bs = &g_bgStats;
+    printf("[Bg] %s, learned %d/%d bins, foreground %u/%u samples, absorbed %u, mqtt skipped %u\n",
+           g_bgEnabled ? "on" : "off", Bg_LearnedBins(), RADAR_FRAME_BINS, bs->foreground, bs->samples,
+           bs->absorbed, bs->mqttSkipped);
+}
+
+/* ============================================================
+ * 目标跟踪
+ * 每帧发布前：把新刷新的相邻角度聚成目标，与已有轨迹按最近邻关联，
+ * (输入是原始读数：逐角度中值滤波要跨扫描确认，会让速度估计晚一整圈)
+ * 用常速度 α-β 更新径向距离与速度，再按最短碰撞时间得出告警等级。
+ * 一帧 (约 1.5 s) 与 TTC_ALARM_MS 同量级，只在帧末更新会让告警最多晚一帧：
+ * 波束扫到已确认轨迹所在的方位格时当即用该读数更新轨迹，碰撞时间与告警等级每个样本都按当前时刻重算。
+ * 全部状态在固定数组中，不用堆。每个样本都会调用，全部为整数运算 (芯片无浮点单元)：
+ * 距离 mm、速度 mm/s、方位 Q8 度、增益 Q16。
+ * ============================================================ */
+
+/* 扫描任务每个样本调用：记录帧内下标 idx 处的原始读数 (mm) 供跟踪器使用 */
+static void Track_Note(int idx, int32_t rawMm)
+{
+    int32_t mm = rawMm > 0 ? rawMm : 0;
+    g_trackRawMm[idx] = (uint16_t)(mm > RADAR_MAX_RANGE_MM ? RADAR_MAX_RANGE_MM : mm);
+    g_trackRawMs[idx] = hi_get_milli_seconds();
+}
+
+/* 把 sinceMs 之后刷新过的相邻角度聚成目标，返回目标数 */
+static int Track_Cluster(uint32_t sinceMs, TrackCluster_t *out, int maxOut)
+{
+    int n = 0;
+    int start = -1;
+    int32_t count = 0, angleSum = 0, minRange = 0, prevMm = 0;
+    uint32_t stamp = 0;
+    for (int i = 0; i <= RADAR_FRAME_BINS; i++)
+    {
+        int32_t mm = (i < RADAR_FRAME_BINS) ? g_trackRawMm[i] : 0;
+        uint8_t fresh = (i < RADAR_FRAME_BINS) && (int32_t)(g_trackRawMs[i] - sinceMs) > 0;
+        uint8_t valid = fresh && mm > 0 && mm <= TRACK_MAX_RANGE_MM;
+        // 当前目标在此处结束：无效角度或距离跳变
+        if (start >= 0 && (!valid || abs(mm - prevMm) > TRACK_CLUSTER_GAP_MM))
+        {
+            if (n < maxOut)
+            {
+                out[n].bearingQ8 = (angleSum * 256 + count / 2) / count;
+                out[n].rangeMm = minRange;
+                out[n].stampMs = stamp;
+                out[n].used = 0;
+                n++;
+            }
+            start = -1;
+        }
+        if (!valid)
+            continue;
+        if (start < 0)
+        {
+            start = i;
+            count = angleSum = 0;
+            minRange = mm;
+            stamp = 0;
+        }
+        angleSum += SCAN_START_ANGLE + i * RADAR_ANGLE_RES_DEG;
+        count++;
+        if (mm < minRange)
+            minRange = mm;
+        prevMm = mm;
+        if ((int32_t)(g_trackRawMs[i] - stamp) > 0)
+            stamp = g_trackRawMs[i];
+    }
+    return n;
+}
+
+/* 方位 (Q8 度) 转帧内下标 */
+static int Track_BinIndex(int32_t bearingQ8)
+{
+    return (bearingQ8 - SCAN_START_ANGLE * 256 + RADAR_ANGLE_RES_DEG * 128) / (RADAR_ANGLE_RES_DEG * 256);
+}
+
+/* 预测 dtMs 之后的距离 (mm)；dt 限幅保证速度 × dt 不溢出 */
+static int32_t Track_Predict(const Track_t *t, int32_t dtMs)
+{
+    if (dtMs > TRACK_DT_MAX_MS)
+        dtMs = TRACK_DT_MAX_MS;
+    else if (dtMs < -TRACK_DT_MAX_MS)
+        dtMs = -TRACK_DT_MAX_MS;
+    return t->rangeMm + t->velMmS * dtMs / 1000;
+}
+
+/* α-β 修正：resid 为测量与预测之差 (在关联门内)，dtMs > 0 */
+static void Track_Correct(Track_t *t, int32_t pred, int32_t resid, int32_t dtMs)
+{
+    t->rangeMm = pred + resid * TRACK_ALPHA_Q16 / 65536;
+    t->velMmS += resid * (TRACK_BETA_Q16 / 16) * 1000 / 4096 / dtMs; // 同 Filter_AlphaBeta，增益先缩 16 倍
+    if (t->velMmS > TRACK_VEL_MAX_MMS)
+        t->velMmS = TRACK_VEL_MAX_MMS;
+    else if (t->velMmS < -TRACK_VEL_MAX_MMS)
+        t->velMmS = -TRACK_VEL_MAX_MMS;
+}
+
+/* 碰撞时间 (ms，已扣除测量至今的时间)；未确认、正在丢失或不在接近中返回 TTC_NONE */
+static uint16_t Track_TtcMs(const Track_t *t, uint32_t nowMs)
+{
+    if (t->hits < TRACK_CONFIRM_HITS || t->misses > 0 || -t->velMmS < TRACK_MIN_CLOSING_MMS)
+        return TTC_NONE;
+    int32_t ttc = t->rangeMm * 1000 / -t->velMmS - (int32_t)(nowMs - t->lastMs);
+    if (ttc <= 0)
+        return 0;
+    return ttc >= TTC_NONE ? TTC_NONE - 1 : (uint16_t)ttc;
+}
+
+/* 按 nowMs 重算最短碰撞时间与告警等级，等级变化时通知告警任务 */
+static void Track_Evaluate(uint32_t nowMs)
+{
+    AlarmState_t alarm = ALARM_SAFE;
+    uint16_t minTtc = TTC_NONE;
+    for (int k = 0; k < TRACK_MAX; k++)
+    {
+        if (!g_tracks[k].active)
+            continue;
+        uint16_t ttc = Track_TtcMs(&g_tracks[k], nowMs);
+        if (ttc < minTtc)
+            minTtc = ttc;
+        if (ttc <= TTC_ALARM_MS)
+            alarm = ALARM_DANGER;
+        else if (ttc <= TTC_WARNING_MS && alarm == ALARM_SAFE)
+            alarm = ALARM_WARNING;
+    }
+    g_trackTtcMs = minTtc;
+    if (alarm != g_trackAlarm)
+    {
+        g_trackAlarm = alarm;
+        osEventFlagsSet(g_alarmEvent, ALARM_EVT_STATE);
+    }
+}
+
+/* 扫描任务每个样本在 Track_Note 之后调用：帧内下标 idx 正是某条已有速度的轨迹的方位格时，
+ * 用这次读数立即做一次 α-β 更新 (本帧整帧关联时不再重复更新它)，然后重算告警等级 */
+static void Track_Sample(int idx)
+{
+    uint32_t nowMs = g_trackRawMs[idx];
+    int32_t mm = g_trackRawMm[idx];
+    for (int k = 0; mm > 0 && mm <= TRACK_MAX_RANGE_MM && k < TRACK_MAX; k++)
+    {
+        Track_t *t = &g_tracks[k];
+        if (!t->active || t->hits < 2 || Track_BinIndex(t->bearingQ8) != idx)
+            continue;
+        int32_t dtMs = (int32_t)(nowMs - t->lastMs);
+        if (dtMs < TRACK_SAMPLE_MIN_MS)
+            continue;
+        int32_t pred = Track_Predict(t, dtMs);
+        int32_t resid = mm - pred;
+        if (abs(resid) > TRACK_GATE_MM)
+            continue;
+        Track_Correct(t, pred, resid, dtMs);
+        t->lastMs = nowMs;
+        if (t->hits < 255)
+            t->hits++;
+        t->misses = 0;
+    }
+    Track_Evaluate(nowMs);
+}
+
+/* 用本帧更新跟踪器，把目标列表写入帧并更新按碰撞时间的告警等级 */
+static void Track_Update(RadarFrame_t *frame)
+{
+    TrackCluster_t clusters[TRACK_MAX * 2];
+    uint32_t sinceMs = g_trackLastMs;
+    int n = Track_Cluster(sinceMs, clusters, TRACK_MAX * 2);
+    g_trackLastMs = hi_get_milli_seconds();
+
+    for (int k = 0; k < TRACK_MAX; k++)
+    {
+        Track_t *t = &g_tracks[k];
+        if (!t->active)
+            continue;
+        // 最近邻关联：方位与预测距离都在门内，取归一化距离最小者
+        // (代价 = 方位差 / 方位门 + 距离差 / 距离门，两边同乘 TRACK_GATE_DEG * TRACK_GATE_MM * 256 以免除法)
+        int best = -1;
+        int32_t bestCost = 2 * TRACK_GATE_DEG * TRACK_GATE_MM * 256;
+        for (int c = 0; c < n; c++)
+        {
+            if (clusters[c].used)
+                continue;
+            int32_t dBearingQ8 = abs(clusters[c].bearingQ8 - t->bearingQ8);
+            int32_t dRangeMm = abs(clusters[c].rangeMm - Track_Predict(t, (int32_t)(clusters[c].stampMs - t->lastMs)));
+            int32_t cost = dBearingQ8 * TRACK_GATE_MM + dRangeMm * TRACK_GATE_DEG * 256;
+            if (dBearingQ8 <= TRACK_GATE_DEG * 256 && dRangeMm <= TRACK_GATE_MM && cost < bestCost)
+            {
+                bestCost = cost;
+                best = c;
+            }
+        }
+        // 本帧内已由 Track_Sample 更新过：聚类只用来刷新方位，不再重复计入距离与速度
+        uint8_t sampled = (int32_t)(t->lastMs - sinceMs) > 0;
+        if (best >= 0 && sampled)
+        {
+            clusters[best].used = 1;
+            t->bearingQ8 = clusters[best].bearingQ8;
+            continue;
+        }
+        if (best >= 0)
+        {
+            TrackCluster_t *m = &clusters[best];
+            m->used = 1;
+            int32_t dtMs = (int32_t)(m->stampMs - t->lastMs);
+            if (dtMs > 1)
+            {
+                if (t->hits == 1)
+                {
+                    // 第二次关联：直接用两点差分初始化速度
+                    int32_t vel = (m->rangeMm - t->rangeMm) * 1000 / dtMs;
+                    t->velMmS = vel > TRACK_VEL_MAX_MMS ? TRACK_VEL_MAX_MMS
+                                : vel < -TRACK_VEL_MAX_MMS ? -TRACK_VEL_MAX_MMS
+                                                            : vel;
+                    t->rangeMm = m->rangeMm;
+                }
+                else
+                {
+                    int32_t pred = Track_Predict(t, dtMs);
+                    Track_Correct(t, pred, m->rangeMm - pred, dtMs);
+                }
+                t->lastMs = m->stampMs;
+            }
+            t->bearingQ8 = m->bearingQ8;
+            if (t->hits < 255)
+                t->hits++;
+            t->misses = 0;
+            continue;
+        }
+        // 未关联：只有目标所在角度在本帧刷新过 (且没有逐样本关联上) 才算丢失一次
+        if (sampled)
+            continue;
+        int idx = Track_BinIndex(t->bearingQ8);
+        if (idx >= 0 && idx < RADAR_FRAME_BINS && (int32_t)(g_trackRawMs[idx] - sinceMs) > 0 &&
+            ++t->misses >= TRACK_MAX_MISSES)
+            t->active = 0;
+    }
+
+    // 未关联的聚类建立新轨迹
+    for (int c = 0; c < n; c++)
+    {
+        if (clusters[c].used)
+            continue;
+        for (int k = 0; k < TRACK_MAX; k++)
+        {
+            Track_t *t = &g_tracks[k];
+            if (t->active)
+                continue;
+            memset(t, 0, sizeof(*t));
+            t->active = 1;
+            t->id = g_trackNextId++;
+            if (g_trackNextId == 0)
+                g_trackNextId = 1;
+            t->hits = 1;
+            t->bearingQ8 = clusters[c].bearingQ8;
+            t->rangeMm = clusters[c].rangeMm;
+            t->lastMs = clusters[c].stampMs;
+            break;
+        }
+    }
+
+    // 写入帧并按最短碰撞时间得出告警等级
+    frame->objectCount = 0;
+    for (int k = 0; k < TRACK_MAX; k++)
+    {
+        const Track_t *t = &g_tracks[k];
+        if (!t->active)
+            continue;
+        RadarObject_t *o = &frame->objects[frame->objectCount++];
+        o->id = t->id;
+        o->bearing = (uint8_t)((t->bearingQ8 + 128) >> 8);
+        o->rangeMm = (uint16_t)(t->rangeMm < 0 ? 0 : t->rangeMm);
+        o->velMmS = (int16_t)(t->hits >= TRACK_CONFIRM_HITS ? t->velMmS : 0);
+        o->ttcMs = Track_TtcMs(t, g_trackLastMs);
+    }
+    Track_Evaluate(g_trackLastMs);
+}
+
+/* ============================================================
+ * 扫描帧池 (零拷贝、引用计数)
+ * 扫描任务从池中取空闲帧，逐角度写入；一次扫描结束后把帧指针投递到
+ * 每个已挂接消费者的邮箱，引用计数等于持有者个数。消费者用完调用
+ * Frame_Release()，最后一个持有者释放后帧回到池中。全程无堆分配，
+ * 新增消费者只需增加一个邮箱，不增加拷贝。
+ * ============================================================ */
+
+/* 角度转帧内下标 */
+static int Frame_BinIndex(uint16_t angle)
+{
+    if (angle <= SCAN_START_ANGLE)
+        return 0;
+    int idx = (angle - SCAN_START_ANGLE + RADAR_ANGLE_RES_DEG / 2) / RADAR_ANGLE_RES_DEG;
+    return idx >= RADAR_FRAME_BINS ? RADAR_FRAME_BINS - 1 : idx;
+}
+
+/* 帧内下标 idx 是否为前景 */
+static uint8_t Frame_IsForeground(const RadarFrame_t *frame, int idx)
+{
+    return (frame->fgMask[idx / 8] >> (idx % 8)) & 1u;
+}
+
+/* 取一个空闲帧，调用者持有一个引用；池耗尽返回 NULL */
+static RadarFrame_t *Frame_Alloc(void)
+{
+    RadarFrame_t *frame = NULL;
+    osMutexAcquire(g_frameMutex, osWaitForever);
+    for (int i = 0; i < FRAME_POOL_SIZE; i++)
+    {
+        if (g_framePool[i].refs == 0)
+        {
+            g_framePool[i].refs = 1;
+            frame = &g_framePool[i].frame;
+            break;
+        }
+    }
+    osMutexRelease(g_frameMutex);
+    return frame;
+}
+
+/* 释放一个引用 */
+static void Frame_Release(const RadarFrame_t *frame)
+{
+    if (frame == NULL)
+        return;
+    FrameSlot_t *slot = (FrameSlot_t *)frame;
+    osMutexAcquire(g_frameMutex, osWaitForever);
+    if (slot->refs > 0)
+        slot->refs--;
+    osMutexRelease(g_frameMutex);
+}
+
+/* 开始新的一帧：以最新发布帧为底，本次扫描未覆盖的角度保留旧值与旧时间戳 */
+static void Frame_Begin(RadarFrame_t *back, int8_t direction)
+{
+    const RadarFrame_t *prev = g_frameLatest; // 只有扫描任务修改 g_frameLatest
+    if (prev != NULL)
+    {
+        memcpy(back->rangeMm, prev->rangeMm, sizeof(back->rangeMm));
+        memcpy(back->stampMs, prev->stampMs, sizeof(back->stampMs));
+        memcpy(back->fgMask, prev->fgMask, sizeof(back->fgMask));
+        back->seq = prev->seq + 1;
+    }
+    else
+    {
+        memset(back, 0, sizeof(RadarFrame_t));
+        back->seq = 1;
+    }
+    back->startMs = hi_get_milli_seconds();
+    back->direction = direction;
+    g_frameBack = back;
+}
+
+/* 写入一个角度的滤波结果 (mm) 与前景标记 (仅扫描任务调用) */
+static void Frame_Store(uint16_t angle, int32_t rangeMm, uint8_t fg)
+{
+    RadarFrame_t *back = g_frameBack;
+    if (back == NULL)
+        return;
+    int idx = Frame_BinIndex(angle);
+    int32_t mm = rangeMm > 0 ? rangeMm : 0;
+    back->rangeMm[idx] = (uint16_t)(mm > RADAR_MAX_RANGE_MM ? RADAR_MAX_RANGE_MM : mm);
+    back->stampMs[idx] = hi_get_milli_seconds();
+    if (fg)
+        back->fgMask[idx / 8] |= (uint8_t)(1u << (idx % 8));
+    else
+        back->fgMask[idx / 8] &= (uint8_t)~(1u << (idx % 8));
+}
+
+/* 消费者开始接收帧 */
+static void Frame_Attach(FrameConsumerId_t id)
+{
+    g_frameConsumers[id].attached = 1;
+}
+
+/* 投递到一个消费者邮箱，满则挤掉最旧的一帧 */
+static void Frame_Post(FrameConsumer_t *c, RadarFrame_t *frame)
+{
+    while (osMessageQueuePut(c->mailbox, &frame, 0, 0) != osOK)
+    {
+        RadarFrame_t *old = NULL;
+        if (osMessageQueueGet(c->mailbox, &old, NULL, 0) == osOK)
+        {
+            Frame_Release(old);
+            c->dropped++;
+        }
+    }
+}
+
+/* 发布后台帧并开始下一帧；池耗尽时继续在当前帧上累积，下次再发布 */
+static void Frame_Publish(int8_t nextDirection)
+{
+    RadarFrame_t *next = Frame_Alloc();
+    if (next == NULL)
+    {
+        g_framePoolExhausted++;
+        return;
+    }
+
+    RadarFrame_t *done = g_frameBack;
+    done->endMs = hi_get_milli_seconds();
+    done->fgCount = 0;
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+        done->fgCount += Frame_IsForeground(done, i);
+    Track_Update(done);
+    osEventFlagsSet(g_alarmEvent, ALARM_EVT_STATE);
+
+    // 分配时的引用转给"最新帧"，每个挂接的消费者再各加一个
+    uint8_t consumers = 0;
+    for (int i = 0; i < FRAME_CONSUMER_COUNT; i++)
+        consumers += g_frameConsumers[i].attached;
+    osMutexAcquire(g_frameMutex, osWaitForever);
+    ((FrameSlot_t *)done)->refs += consumers;
+    RadarFrame_t *prev = g_frameLatest;
+    g_frameLatest = done;
+    osMutexRelease(g_frameMutex);
+
+    for (int i = 0, posted = 0; i < FRAME_CONSUMER_COUNT && posted < consumers; i++)
+    {
+        if (g_frameConsumers[i].attached)
+        {
+            Frame_Post(&g_frameConsumers[i], done);
+            posted++;
+        }
+    }
+
+    Frame_Begin(next, nextDirection);
+    Frame_Release(prev);
+}
+
+/* 消费者取帧 (按节拍超时)，用完必须 Frame_Release；超时返回 NULL */
+static const RadarFrame_t *Frame_Receive(FrameConsumerId_t id, uint32_t timeout)
+{
+    FrameConsumer_t *c = &g_frameConsumers[id];
+    RadarFrame_t *frame = NULL;
+    if (osMessageQueueGet(c->mailbox, &frame, NULL, timeout) != osOK)
+        return NULL;
+    uint32_t lag = hi_get_milli_seconds() - frame->endMs;
+    c->received++;
+    c->lagMsSum += lag;
+    if (lag > c->lagMsMax)
+        c->lagMsMax = lag;
+    return frame;
+}
+
+/* 帧内最近目标的下标，无目标返回 -1 */
+static int Frame_Nearest(const RadarFrame_t *frame, uint8_t fgOnly)
+{
+    int nearest = -1;
+    for (int i = 0; i < RADAR_FRAME_BINS; i++)
+    {
+        if (fgOnly && !Frame_IsForeground(frame, i))
+            continue;
+        if (frame->rangeMm[i] > 0 && (nearest < 0 || frame->rangeMm[i] < frame->rangeMm[nearest]))
+            nearest = i;
+    }
+    return nearest;
+}
+
+/* 打印帧池与各消费者的分发统计 */
+static void Frame_PrintStats(void)
+{
+    int freeSlots = 0;
+    for (int i = 0; i < FRAME_POOL_SIZE; i++)
+        freeSlots += (g_framePool[i].refs == 0);
+    printf("[Frame] pool free %d/%d, exhausted %u\n", freeSlots, FRAME_POOL_SIZE, g_framePoolExhausted);
+    for (int i = 0; i < FRAME_CONSUMER_COUNT; i++)
+    {
+        const FrameConsumer_t *c = &g_frameConsumers[i];
+        printf("[Frame]   %-7s recv %u drop %u lag avg %u ms max %u ms\n", c->name, c->received, c->dropped,
+               c->received ? c->lagMsSum / c->received : 0, c->lagMsMax);
+    }
+}
+
+/* ============================================================
+ * 整帧上报
+ * 每个扫描帧一条消息：帧序号、扫描起止时刻与方向，全部角度的距离 (mm) 与
+ * 测距时刻 (相对帧发布时刻的毫秒数，-1 表示从未测到)，前景位图与跟踪目标。
+ * 角度不逐个写出：第 i 个距离对应 a0 + i * da 度。
+ * JSON 里 angle/dist/state 保持原单点上报的含义 (舵机当前角度及该角度滤波后的距离，cm)，
+ * 最近的前景目标另放在 na/nd (没有时 na 为 -1)。
+ * 默认用紧凑二进制 (radar_sweep.h)：距离相对上一条上报差分编码，相同的角度
+ * 成段省略，小变化 1 字节；每 MQTT_SWEEP_KEY_EVERY 条一个关键帧。JSON 保留给现有 HTML 端。
+ * ============================================================ */
+
+_Static_assert(MQTT_SWEEP_PAYLOAD >= SWEEP_MAX_SIZE(RADAR_FRAME_BINS, TRACK_MAX),
+               "MQTT_SWEEP_PAYLOAD too small for a worst-case binary sweep");
+
+/* 把一帧格式化为 JSON，返回长度。
+ * 缓冲不足时停止输出剩余的距离/测距时刻/目标并计数，但仍补全括号，保证是合法 JSON：
+ * 每个元素写出前检查余量，余量留足一个最长元素加上收尾 (括号与前景位图) */
+static int Sweep_Format(const RadarFrame_t *frame, const RadarState_t *st, char *buf, int size)
+{
+    const int limit = size - (64 + 2 * (int)sizeof(frame->fgMask));
+    uint8_t truncated = 0;
+    int nearest = Frame_Nearest(frame, 1);
+    unsigned mm = nearest < 0 ? 0 : frame->rangeMm[nearest]; // 按 cm 输出一位小数，不走浮点格式化
+    int len = snprintf(buf, size,
+                       "{\"seq\":%u,\"t0\":%u,\"t1\":%u,\"dir\":%d,\"a0\":%d,\"da\":%d,\"angle\":%d,\"dist\":%u.%u,"
+                       "\"state\":%d,\"na\":%d,\"nd\":%u.%u,\"fg\":%u,\"r\":[",
+                       frame->seq, frame->startMs, frame->endMs, frame->direction, SCAN_START_ANGLE,
+                       RADAR_ANGLE_RES_DEG, st->angle, st->rangeMm / 10, st->rangeMm % 10, st->sysState,
+                       nearest < 0 ? -1 : SCAN_START_ANGLE + nearest * RADAR_ANGLE_RES_DEG, mm / 10, mm % 10,
+                       frame->fgCount);
+    if (len >= limit)
+    {
+        // 连头都放不下：不输出半条消息
+        g_sweepPubStats.truncated++;
+        buf[0] = '\0';
+        return 0;
+    }
+    for (int i = 0; i < RADAR_FRAME_BINS && !truncated; i++)
+    {
+        if (len >= limit)
+            truncated = 1;
+        else
+            len += snprintf(buf + len, size - len, "%s%u", i ? "," : "", frame->rangeMm[i]);
+    }
+    len += snprintf(buf + len, size - len, "],\"age\":[");
+    for (int i = 0; i < RADAR_FRAME_BINS && !truncated; i++)
+    {
+        int age = frame->stampMs[i] ? (int)(frame->endMs - frame->stampMs[i]) : -1;
+        if (len >= limit)
+            truncated = 1;
+        else
+            len += snprintf(buf + len, size - len, "%s%d", i ? "," : "", age);
+    }
+    len += snprintf(buf + len, size - len, "],\"fgm\":\"");
+    for (int i = 0; i < (int)sizeof(frame->fgMask); i++)
+        len += snprintf(buf + len, size - len, "%02x", frame->fgMask[i]);
+    len += snprintf(buf + len, size - len, "\",\"objs\":[");
+    // 目标列表：[编号, 方位, 距离 mm, 径向速度 mm/s, 碰撞时间 ms (-1 表示不在接近中)]
+    for (int i = 0; i < frame->objectCount && !truncated; i++)
+    {
+        if (len >= limit)
+        {
+            truncated = 1;
+            break;
+        }
+        const RadarObject_t *o = &frame->objects[i];
+        len += snprintf(buf + len, size - len, "%s[%u,%u,%u,%d,%d]", i ? "," : "", o->id, o->bearing, o->rangeMm,
+                        o->velMmS, o->ttcMs == TTC_NONE ? -1 : (int)o->ttcMs);
+    }
+    len += snprintf(buf + len, size - len, "]}");
+    if (truncated)
+        g_sweepPubStats.truncated++;
+    return len < size ? len : size - 1;
+}
+
+static void Sweep_PutU16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void Sweep_PutU32(uint8_t *p, uint32_t v)
+{
+    Sweep_PutU16(p, (uint16_t)v);
+    Sweep_PutU16(p + 2, (uint16_t)(v >> 16));
+}
+
+/* 把一帧编码为二进制 (base 为 NULL 时编码关键帧)，返回长度。
+ * 缓冲按最坏情况 SWEEP_MAX_SIZE 确定 (见 MQTT_SWEEP_PAYLOAD 处的断言)，不做越界检查 */
+static int Sweep_Encode(const RadarFrame_t *frame, const RadarState_t *st, const uint16_t *base, uint32_t baseSeq,
+                        uint8_t *buf)
+{
+    buf[0] = SWEEP_MAGIC;
+    buf[1] = SWEEP_VERSION;
+    buf[2] = base == NULL ? SWEEP_FLAG_KEY : 0;
+    buf[3] = RADAR_FRAME_BINS;
+    Sweep_PutU32(buf + 4, frame->seq);
+    Sweep_PutU32(buf + 8, base == NULL ? 0 : baseSeq);
+    Sweep_PutU32(buf + 12, frame->endMs);
+    uint32_t span = frame->endMs - frame->startMs;
+    Sweep_PutU16(buf + 16, (uint16_t)(span > 0xFFFF ? 0xFFFF : span));
+    buf[18] = SCAN_START_ANGLE;
+    buf[19] = RADAR_ANGLE_RES_DEG;
+    buf[20] = (uint8_t)frame->direction;
+    buf[21] = (uint8_t)st->sysState;
+    buf[22] = frame->fgCount;
+    buf[23] = frame->objectCount;
+    int pos = SWEEP_HDR_SIZE;
+    memcpy(buf + pos, frame->fgMask, sizeof(frame->fgMask));
+    pos += sizeof(frame->fgMask);
+
+    // 距离块：与基准相同的连续角度 (至少 2 个) 成段省略，差分在 int8 内的 1 字节，其余 2 字节绝对值
+    int i = 0;
+    while (i < RADAR_FRAME_BINS)
+    {
+        int same = 0;
+        while (i + same < RADAR_FRAME_BINS && same < SWEEP_OP_RUN_MAX &&
+               frame->rangeMm[i + same] == (base ? base[i + same] : 0))
+            same++;
+        if (same >= 2 || (same == 1 && i + 1 == RADAR_FRAME_BINS))
+        {
+            buf[pos++] = (uint8_t)(SWEEP_OP_SAME | (same - 1));
+            i += same;
+            continue;
+        }
+        int32_t d = (int32_t)frame->rangeMm[i] - (base ? base[i] : 0);
+        uint8_t small = (d >= -128 && d <= 127);
+        int op = pos++;
+        int run = 0;
+        while (i < RADAR_FRAME_BINS && run < SWEEP_OP_RUN_MAX)
+        {
+            d = (int32_t)frame->rangeMm[i] - (base ? base[i] : 0);
+            if ((d >= -128 && d <= 127) != small)
+                break;
+            // 前方有 2 个以上相同的角度时结束本段，交给省略段
+            if (run > 0 && d == 0 && i + 1 < RADAR_FRAME_BINS &&
+                frame->rangeMm[i + 1] == (base ? base[i + 1] : 0))
+                break;
+            if (small)
+            {
+                buf[pos++] = (uint8_t)(int8_t)d;
+            }
+            else
+            {
+                Sweep_PutU16(buf + pos, frame->rangeMm[i]);
+                pos += 2;
+            }
+            i++;
+            run++;
+        }
+        buf[op] = (uint8_t)((small ? SWEEP_OP_DELTA8 : SWEEP_OP_ABS16) | (run - 1));
+    }
+
+    // 测距时刻块
+    for (i = 0; i < RADAR_FRAME_BINS; i++)
+    {
+        uint32_t age = (frame->endMs - frame->stampMs[i] + SWEEP_AGE_UNIT_MS / 2) / SWEEP_AGE_UNIT_MS;
+        buf[pos++] = frame->stampMs[i] == 0 ? SWEEP_AGE_NONE : (uint8_t)(age > SWEEP_AGE_MAX ? SWEEP_AGE_MAX : age);
+    }
+
+    // 目标表
+    for (i = 0; i < frame->objectCount; i++, pos += SWEEP_OBJ_SIZE)
+    {
+        const RadarObject_t *o = &frame->objects[i];
+        buf[pos] = o->id;
+        buf[pos + 1] = o->bearing;
+        Sweep_PutU16(buf + pos + 2, o->rangeMm);
+        Sweep_PutU16(buf + pos + 4, (uint16_t)o->velMmS);
+        Sweep_PutU16(buf + pos + 6, o->ttcMs);
+    }
+    return pos;
+}
+
+/* 打印整帧上报统计 */
+static void Sweep_PrintStats(void)
+{
+    const SweepPubStats_t *ps = &g_sweepPubStats;
+    printf("[Sweep] %s, %u frames, published %u (key %u), rate skipped %u (min %u ms), truncated %u, "
+           "avg %u B (max %u)\n", g_sweepFormat == SWEEP_FORMAT_BINARY ? "binary" : "json", ps->frames,
+           ps->published, ps->keyframes, ps->rateSkipped, g_sweepMinIntervalMs, ps->truncated,
+           ps->published ? (uint32_t)(ps->bytes / ps->published) : 0, ps->bytesMax);
+    MqttPubqStats_t qs;
+    MqttPubq_GetStats(&qs);
+    printf("[PubQ] queued %u, sent %u, dropped %u old + %u new, purged %u, send errors %u, backlog %u B (max %u), "
+           "latency avg %u ms (max %u)\n", qs.queued, qs.sent, qs.droppedOldest, qs.droppedNewest, qs.purged,
+           qs.sendErrors, qs.queuedBytes, qs.queuedBytesMax,
+           qs.sent ? (uint32_t)(qs.latencySumUs / qs.sent / 1000) : 0, qs.latencyMaxUs / 1000);
+}
+
+/* ============================================================
+ * 扫描扇区：访问间隔统计与自适应调度
+ * ============================================================ */
+
+static int Sector_Index(uint16_t angle)
+{
+    int idx = (angle > SCAN_START_ANGLE) ? (angle - SCAN_START_ANGLE) / ADAPT_SECTOR_DEG : 0;
+    return idx >= ADAPT_SECTOR_COUNT ? ADAPT_SECTOR_COUNT - 1 : idx;
+}
+
+/* 每个样本调用 (仅扫描任务)：样本落入与上一样本不同的扇区即记一次访问，
+ * 统计同一扇区两次访问的间隔，各扫描策略都适用 */
+static void Sector_Note(uint16_t angle)
+{
+    int s = Sector_Index(angle);
+    if (s == g_sectorLast)
+        return;
+    g_sectorLast = (int8_t)s;
+
+    uint32_t now = hi_get_milli_seconds();
+    if (g_sectorStrategy != g_scanStrategy)
+    {
+        g_sectorStrategy = g_scanStrategy;
+        g_sectorStrategyMs = now;
+    }
+    RevisitStats_t *rs = &g_revisitStats[g_scanStrategy][s];
+    if (g_sectorSeenMs[s] != 0 && (int32_t)(g_sectorSeenMs[s] - g_sectorStrategyMs) >= 0)
+    {
+        uint32_t interval = now - g_sectorSeenMs[s];
+        rs->intervalMsSum += interval;
+        if (interval > rs->intervalMsMax)
+            rs->intervalMsMax = interval;
+    }
+    rs->visits++;
+    g_sectorSeenMs[s] = now;
+}
+
+/* 选择下一个访问的扇区：快到最长访问间隔的扇区优先 (取最紧迫者，*coarse 置 1 只做粗扫以尽快覆盖)；
+ * 否则按 (已等待时间 - 转过去的时间) x 权重 取最大，权重 = 基础权重 + 兴趣度 */
+static int Sector_Schedule(uint8_t *coarse)
 {
-    static uint32_t lastBlinkTime = 0;
-    static uint8_t ledState = 0;
-
-    switch (state)
+    uint32_t now = hi_get_milli_seconds();
+    int due = -1;
+    int32_t dueSlack = ADAPT_DUE_MARGIN_MS;
+    int best = 0;
+    int32_t bestScore = INT32_MIN;
+    for (int s = 0; s < ADAPT_SECTOR_COUNT; s++)
     {
-    case ALARM_SAFE:
-        LED(0);
-        BEEP(0);
-        ledState = 0;
-        break;
-    case ALARM_WARNING:
-        BEEP(0);
+        int32_t age = (int32_t)(now - g_sectorSeenMs[s]);
+        int32_t slack = ADAPT_MAX_REVISIT_MS - age;
+        if (slack < dueSlack)
         {
-            uint32_t currentTime = osKernelGetTickCount();
-            if (currentTime - lastBlinkTime >= 50)
-            {
-                ledState = !ledState;
-                LED(ledState);
-                lastBlinkTime = currentTime;
-            }
+            dueSlack = slack;
+            due = s;
+        }
+        uint16_t center = SCAN_START_ANGLE + s * ADAPT_SECTOR_DEG + ADAPT_SECTOR_DEG / 2;
+        uint16_t delta = center > g_servoTarget ? center - g_servoTarget : g_servoTarget - center;
+        int32_t score = (age - (int32_t)(Servo_SettleUs(delta) / 1000)) * (ADAPT_INTEREST_BASE + g_sectorInterest[s]);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = s;
         }
-        break;
-    case ALARM_DANGER:
-        LED(1);
-        BEEP(1);
-        ledState = 1;
-        break;
     }
+    *coarse = (due >= 0);
+    return due >= 0 ? due : best;
 }
 
-/* 告警状态判定 */
-static AlarmState_t Get_AlarmState(float distance)
+/* 一次访问结束后更新兴趣度：先衰减，再按本次是否有目标/告警加分 */
+static void Sector_UpdateInterest(int s, uint8_t hit, uint8_t alarm)
 {
-    if (distance <= 0 || distance > 400)
-        return ALARM_SAFE;
-    if (distance <= ALARM_DISTANCE_CM)
-        return ALARM_DANGER;
-    else if (distance <= WARNING_DISTANCE_CM)
-        return ALARM_WARNING;
-    else
-        return ALARM_SAFE;
+    uint32_t v = g_sectorInterest[s] * 3u / 4u;
+    if (hit)
+        v += ADAPT_INTEREST_HIT;
+    if (alarm)
+        v += ADAPT_INTEREST_ALARM;
+    g_sectorInterest[s] = (uint8_t)(v > 100 ? 100 : v);
 }
 
-/* 查表法 Sin 函数 */
-static float GetSin(int angle)
+/* 打印各扇区兴趣度与访问间隔 */
+static void Sector_PrintStats(void)
 {
-    const float sin_val[] = {
-        0.0000f, 0.0872f, 0.1736f, 0.2588f, 0.3420f, 0.4226f, 0.5000f, 0.5736f, 0.6428f, 0.7071f,
-        0.7660f, 0.8192f, 0.8660f, 0.9063f, 0.9397f, 0.9659f, 0.9848f, 0.9962f, 1.0000f};
-    if (angle < 0)
-        angle = 0;
-    if (angle > 180)
-        angle = 180;
-    int index = (angle + 2) / 5;
-    if (index > 18)
-        index = 18;
-    if (angle <= 90)
-        return sin_val[index];
-    else
+    printf("[Revisit] %s:", g_scanStrategyName[g_scanStrategy]);
+    for (int s = 0; s < ADAPT_SECTOR_COUNT; s++)
     {
-        int mirror_angle = 180 - angle;
-        index = (mirror_angle + 2) / 5;
-        return sin_val[index];
+        const RevisitStats_t *rs = &g_revisitStats[g_scanStrategy][s];
+        uint32_t n = rs->visits > 1 ? rs->visits - 1 : 0;
+        printf(" %d-%d i%u %u/%u", SCAN_START_ANGLE + s * ADAPT_SECTOR_DEG,
+               SCAN_START_ANGLE + (s + 1) * ADAPT_SECTOR_DEG, g_sectorInterest[s], n ? rs->intervalMsSum / n : 0,
+               rs->intervalMsMax);
     }
-}
-
-/* 查表法 Cos 函数 */
-static float GetCos(int angle)
-{
-    if (angle < 0)
-        angle = 0;
-    if (angle > 180)
-        angle = 180;
-    if (angle <= 90)
-        return GetSin(90 - angle);
-    else
-        return -GetSin(angle - 90);
+    printf(" ms (avg/max)\n");
 }
 
 /* ============================================================
@@ -231,31 +2879,18 @@ static void Key_ScanTask(void *arg)
             uint32_t currentTime = osKernelGetTickCount();
             if (currentTime - lastPressTime > 300)
             {
-                osMutexAcquire(g_systemMutex, osWaitForever);
-
                 if (keyValue == KEY1_PRESS)
                 {
                     // Key 1: 启动扫描
-                    if (!g_scanEnabled)
-                    {
-                        g_scanEnabled = 1;
-                        g_systemState = SYSTEM_SCANNING;
+                    if (State_SetScanEnabled(1))
                         printf("Key1: Start Scan\n");
-                    }
                 }
                 else if (keyValue == KEY2_PRESS)
                 {
                     // Key 2: 停止扫描
-                    if (g_scanEnabled)
-                    {
-                        g_scanEnabled = 0;
-                        g_systemState = SYSTEM_STOPPED;
-                        set_sg90_angle(90); // 复位到中间
+                    if (State_SetScanEnabled(0))
                         printf("Key2: Stop Scan\n");
-                    }
                 }
-
-                osMutexRelease(g_systemMutex);
                 lastPressTime = currentTime;
             }
         }
@@ -263,95 +2898,492 @@ static void Key_ScanTask(void *arg)
     }
 }
 
-/* 雷达扫描任务 */
+/* 记录一次告警延迟 (首次危险读数的触发时刻 -> 输出) */
+static void Alarm_RecordLatency(uint32_t latencyUs)
+{
+    AlarmLatencyStats_t *st = &g_alarmLatency;
+    uint32_t ms = latencyUs / 1000;
+    int bin = 0;
+    while (bin < ALARM_HIST_BINS - 1 && ms >= g_alarmHistEdgesMs[bin])
+        bin++;
+    st->hist[bin]++;
+    st->count++;
+    st->sumUs += latencyUs;
+    if (latencyUs > st->maxUs)
+        st->maxUs = latencyUs;
+}
+
+/* 打印告警延迟直方图 */
+static void Alarm_PrintStats(void)
+{
+    const AlarmLatencyStats_t *st = &g_alarmLatency;
+    printf("[Alarm] %u alarms, rejects %u, latency avg %u ms max %u ms |", st->count, st->rejects, st->count ? st->sumUs / st->count / 1000 : 0, st->maxUs / 1000);
+    for (int i = 0; i < ALARM_HIST_BINS; i++)
+    {
+        if (i < ALARM_HIST_BINS - 1)
+            printf(" <%u:%u", g_alarmHistEdgesMs[i], st->hist[i]);
+        else
+            printf(" >=%u:%u", g_alarmHistEdgesMs[i - 1], st->hist[i]);
+    }
+    printf("\n");
+}
+
+/* 告警任务 (最高优先级)：唯一驱动蜂鸣器与 LED 的地方。
+ * 快速通道：回波中断按原始读数置 NEAR/FAR，连续 ALARM_CONFIRM_PINGS 次 NEAR 即锁存危险，
+ * 最后一次 NEAR 后保持 ALARM_HOLD_MS；未锁存时输出跟踪器按碰撞时间得出的等级 (警告闪烁等)。
+ * 逐角度滤波后的告警状态只用于显示与上报，不驱动输出 */
+static void Alarm_Task(void *arg)
+{
+    (void)arg;
+    uint8_t nearRun = 0;
+    uint8_t latched = 0;
+    uint8_t confirmed = 0; // 本次唤醒刚确认，输出后记录延迟
+    uint32_t firstNearUs = 0;
+    uint32_t lastNearUs = 0;
+
+    while (1)
+    {
+        uint32_t flags = osEventFlagsWait(g_alarmEvent, ALARM_EVT_NEAR | ALARM_EVT_FAR | ALARM_EVT_STATE,
+                                          osFlagsWaitAny, Radar_MsToTicks(ALARM_POLL_MS));
+        if (flags & osFlagsError)
+            flags = 0;
+        uint32_t now = hi_get_us();
+
+        // 两次唤醒之间可能来了多次读数：NEAR 与 FAR 同时置位时，最后到达的那个决定当前读数，
+        // 先处理另一个 (否则 FAR 之后的 NEAR 会被 FAR 清掉，或 NEAR 之后的 FAR 没能清零计数)
+        uint32_t first = (g_alarmLastRaw == ALARM_EVT_NEAR) ? ALARM_EVT_FAR : ALARM_EVT_NEAR;
+        const uint32_t order[2] = {first, first ^ (ALARM_EVT_NEAR | ALARM_EVT_FAR)};
+        for (int k = 0; k < 2; k++)
+        {
+            if (!(flags & order[k]))
+                continue;
+            if (order[k] == ALARM_EVT_NEAR)
+            {
+                if (nearRun == 0)
+                    firstNearUs = g_alarmPingUs;
+                if (nearRun < ALARM_CONFIRM_PINGS)
+                    nearRun++;
+                lastNearUs = now;
+                if (nearRun >= ALARM_CONFIRM_PINGS && !latched)
+                {
+                    latched = 1;
+                    confirmed = 1;
+                }
+            }
+            else
+            {
+                if (nearRun > 0 && !latched)
+                    g_alarmLatency.rejects++;
+                nearRun = 0;
+            }
+        }
+
+        // 扫描停止后不会再有 FAR 来清零计数，锁存随之撤销
+        RadarState_t st;
+        State_Read(&st);
+        if (!st.scanEnabled)
+        {
+            latched = 0;
+            nearRun = 0;
+            confirmed = 0;
+        }
+        if (latched && nearRun == 0 && (now - lastNearUs) >= ALARM_HOLD_MS * 1000)
+            latched = 0;
+
+        AlarmState_t next = ALARM_DANGER;
+        if (!latched)
+            next = st.scanEnabled ? g_trackAlarm : ALARM_SAFE;
+        Alarm_Control(next);
+        if (confirmed)
+        {
+            Alarm_RecordLatency(hi_get_us() - firstNearUs);
+            confirmed = 0;
+        }
+    }
+}
+
+/* 样本处理：滤波、告警判定并发送到队列 (rawMm < 0 表示本步未测距)
+ * 返回滤波后的距离 (mm)，未测距返回 -1 */
+static int32_t Radar_ProcessSample(uint16_t angle, int32_t rawMm)
+{
+    Sector_Note(angle);
+
+    // 锁内只做滤波与状态发布，告警输出和队列投递在锁外
+    State_Lock();
+    if (!g_state.scanEnabled)
+    {
+        State_Unlock();
+        return -1;
+    }
+
+    RadarState_t next = g_state;
+    next.angle = angle;
+    if (rawMm >= 0)
+    {
+        // 本角度独立滤波
+        next.rangeMm = (uint16_t)Filter_Update(angle, rawMm);
+        next.alarmState = Get_AlarmState(next.rangeMm);
+
+        // 只有在这里显式确认状态
+        next.sysState = (next.alarmState == ALARM_DANGER) ? SYSTEM_ALARM : SYSTEM_SCANNING;
+    }
+    State_Publish(&next);
+    State_Unlock();
+
+    if (rawMm >= 0)
+    {
+        // 背景读数不进入跟踪器，目标与碰撞告警只看前景
+        int idx = Frame_BinIndex(angle);
+        uint8_t fg = Bg_Update(idx, rawMm);
+        Frame_Store(angle, next.rangeMm, fg);
+        Track_Note(idx, fg ? rawMm : 0);
+        Track_Sample(idx);
+        if (g_oledEvent != NULL)
+            osEventFlagsSet(g_oledEvent, OLED_EVT_STATE);
+        return next.rangeMm;
+    }
+    return -1;
+}
+
+/* 一次扫描结束：累计并打印实际采样率，与原抽样设计对比 */
+static void Radar_SweepDone(uint32_t samples, uint32_t sweepStartUs)
+{
+    RangingStats_t *st = &g_rangingStats[g_rangingMode];
+    uint32_t elapsed = hi_get_us() - sweepStartUs;
+    st->sweeps++;
+    st->samples += samples;
+    st->elapsedUs += elapsed;
+
+    const RangingStats_t *pipe = &g_rangingStats[RANGING_PIPELINED];
+    const RangingStats_t *deci = &g_rangingStats[RANGING_DECIMATED];
+    uint32_t pipeRate = pipe->elapsedUs ? (uint32_t)((uint64_t)pipe->samples * 100000000ULL / pipe->elapsedUs) : 0;
+    uint32_t deciRate = deci->elapsedUs ? (uint32_t)((uint64_t)deci->samples * 100000000ULL / deci->elapsedUs) : 0;
+    printf("[Rate] %s sweep: %u samples in %u ms | pipelined %u.%02u/s, decimated %u.%02u/s\n",
+           g_rangingMode == RANGING_PIPELINED ? "pipelined" : "decimated", samples, elapsed / 1000,
+           pipeRate / 100, pipeRate % 100, deciRate / 100, deciRate % 100);
+
+    // 各扫描策略的每分钟扫描次数
+    g_scanStats[g_scanStrategy].sweeps++;
+    g_scanStats[g_scanStrategy].samples += samples;
+    g_scanStats[g_scanStrategy].elapsedUs += elapsed;
+    printf("[Scan]");
+    for (int i = 0; i < SCAN_STRATEGY_COUNT; i++)
+    {
+        const RangingStats_t *ss = &g_scanStats[i];
+        printf(" %s%s %u", g_scanStrategyName[i], i == (int)g_scanStrategy ? "*" : "",
+               ss->elapsedUs ? (uint32_t)((uint64_t)ss->sweeps * 60000000ULL / ss->elapsedUs) : 0);
+    }
+    printf(" sweeps/min");
+    if (g_contTickSkips)
+        printf(", servo ticks skipped %u", g_contTickSkips);
+    printf("\n");
+
+    // 各距离门实际达到的触发率
+    g_gateStats[g_rangeGate].pings += samples;
+    g_gateStats[g_rangeGate].elapsedUs += elapsed;
+    for (int i = 0; i < GATE_COUNT; i++)
+    {
+        const GateStats_t *gs = &g_gateStats[i];
+        uint32_t rate = gs->elapsedUs ? (uint32_t)((uint64_t)gs->pings * 100000000ULL / gs->elapsedUs) : 0;
+        printf("[Gate] %3u cm%s: %u pings, %u.%02u pings/s\n", g_gateRangeCm[i], i == (int)g_rangeGate ? "*" : " ",
+               gs->pings, rate / 100, rate % 100);
+    }
+}
+
+/* 连续扫描的指令轨迹：从 fromQ8 出发匀速转向 toQ8，elapsedUs 后的角度 (均为 Q8 度)。
+ * 整数运算 (每个定时器节拍都要算)：时间先限在走完整个扫描范围以内，千分之一度的中间量不溢出 */
+static int32_t Radar_TrajectoryAt(int32_t fromQ8, int32_t toQ8, int32_t elapsedUs)
+{
+    const int32_t fullUs = (SCAN_END_ANGLE - SCAN_START_ANGLE) * 1000000 / CONT_SWEEP_DEG_PER_S;
+    if (elapsedUs < 0)
+        elapsedUs = 0;
+    else if (elapsedUs > fullUs)
+        elapsedUs = fullUs;
+    int32_t spanQ8 = elapsedUs * CONT_SWEEP_DEG_PER_S / 1000 * 256 / 1000;
+    if (toQ8 > fromQ8)
+        return (fromQ8 + spanQ8 > toQ8) ? toQ8 : fromQ8 + spanQ8;
+    return (fromQ8 - spanQ8 < toQ8) ? toQ8 : fromQ8 - spanQ8;
+}
+
+/* 连续扫描舵机定时器：每个节拍把舵机指令推进到轨迹当前位置 */
+static void Radar_ContServoTick(void *arg)
+{
+    (void)arg;
+    if (!g_state.scanEnabled || g_scanStrategy != SCAN_CONTINUOUS)
+        return;
+    int32_t cmdQ8 = Radar_TrajectoryAt(g_contFromQ8, g_contToQ8, (int32_t)(hi_get_us() - g_contT0));
+    if (!Servo_TryMove((uint16_t)((cmdQ8 + 128) >> 8)))
+        g_contTickSkips++; // 下一节拍按轨迹直接追上
+}
+
+/* 连续扫描一趟：舵机由定时器驱动沿匀速轨迹不停转动，测距按固定节拍触发；
+ * 每个样本的角度取声波到达目标时刻在轨迹上的插值 (扣除舵机跟随滞后)。
+ * 样本照常经 Radar_ProcessSample 进入滤波器与扫描帧，返回测距次数 */
+static uint32_t Radar_ContinuousSweep(int8_t direction)
+{
+    uint32_t samples = 0;
+    uint8_t hasPending = 0;
+    uint16_t pendingAngle = 0;
+    int32_t pendingMm = -1;
+
+    g_contFromQ8 = g_servoTarget * 256;
+    g_contToQ8 = (direction > 0 ? SCAN_END_ANGLE : SCAN_START_ANGLE) * 256;
+    g_contT0 = hi_get_us();
+    osTimerStart(g_contServoTimer, CONT_SERVO_TICKS);
+
+    while (g_state.scanEnabled && g_scanStrategy == SCAN_CONTINUOUS)
+    {
+        uint32_t trigAt = hi_get_us();
+        if (Radar_TrajectoryAt(g_contFromQ8, g_contToQ8, (int32_t)(trigAt - g_contT0)) == g_contToQ8)
+            break;
+
+        Sr04Async_Trigger();
+        if (hasPending)
+            Radar_ProcessSample(pendingAngle, pendingMm);
+        pendingMm = Sr04Async_Wait();
+        int32_t angleQ8 =
+            Radar_TrajectoryAt(g_contFromQ8, g_contToQ8, (int32_t)(g_sr04EchoUs - g_contT0) - CONT_TRACK_LAG_US);
+        pendingAngle = (uint16_t)((angleQ8 + 128) >> 8);
+        hasPending = 1;
+        samples++;
+
+        Radar_WaitUntil(trigAt + CONT_PING_INTERVAL_MS * 1000);
+    }
+    osTimerStop(g_contServoTimer);
+    if (g_state.scanEnabled && g_scanStrategy == SCAN_CONTINUOUS)
+        Servo_Move((uint16_t)(g_contToQ8 >> 8));
+    if (hasPending)
+        Radar_ProcessSample(pendingAngle, pendingMm);
+    return samples;
+}
+
+/* 自适应扫描访问一个扇区：兴趣度高的扇区按细步进逐角度测距，否则 (或 coarse 置位时) 粗扫；
+ * 从离舵机较近的一端开始，测距流水线与逐步扫描相同。返回测距次数 */
+static uint32_t Radar_AdaptivePass(int sector, uint8_t coarse, uint32_t *lastPingUs)
+{
+    uint8_t fine = !coarse && g_sectorInterest[sector] >= ADAPT_INTEREST_FINE;
+    uint16_t step = fine ? ADAPT_FINE_STEP : ADAPT_COARSE_STEP;
+    uint16_t lo = SCAN_START_ANGLE + sector * ADAPT_SECTOR_DEG;
+    uint16_t first = fine ? lo : lo + ADAPT_COARSE_STEP / 2;
+    uint16_t last = first + (ADAPT_SECTOR_DEG - 1 - (first - lo)) / step * step;
+    if (fine && sector == ADAPT_SECTOR_COUNT - 1)
+        last = SCAN_END_ANGLE; // 最后一个扇区包含终点角度
+    int8_t direction = 1;
+    if ((g_servoTarget > last ? g_servoTarget - last : last - g_servoTarget) <
+        (g_servoTarget > first ? g_servoTarget - first : first - g_servoTarget))
+    {
+        uint16_t t = first;
+        first = last;
+        last = t;
+        direction = -1;
+    }
+    if (g_frameBack != NULL)
+        g_frameBack->direction = direction;
+
+    uint32_t samples = 0;
+    uint8_t hit = 0;
+    uint8_t alarm = 0;
+    uint8_t hasPending = 0;
+    uint16_t pendingAngle = 0;
+    int32_t pendingMm = -1;
+    g_sectorLast = -1; // 连续两次访问同一扇区也各记一次
+    for (uint16_t angle = first; g_state.scanEnabled && g_scanStrategy == SCAN_ADAPTIVE;
+         angle = (uint16_t)(angle + direction * step))
+    {
+        Servo_Move(angle);
+        uint32_t readyUs = g_servoReadyUs;
+        if ((int32_t)(*lastPingUs + Sr04Async_GapUs() - readyUs) > 0)
+            readyUs = *lastPingUs + Sr04Async_GapUs();
+        Radar_WaitUntil(readyUs);
+
+        Sr04Async_Trigger();
+        if (hasPending)
+        {
+            int32_t mm = Radar_ProcessSample(pendingAngle, pendingMm);
+            hit |= (mm > 0 && mm < ADAPT_TARGET_CM * 10 && Bg_IsForeground(Frame_BinIndex(pendingAngle)));
+            alarm |= (mm > 0 && mm <= WARNING_DISTANCE_MM);
+        }
+        pendingMm = Sr04Async_Wait();
+        *lastPingUs = hi_get_us();
+        pendingAngle = angle;
+        hasPending = 1;
+        samples++;
+        if (angle == last)
+            break;
+    }
+    if (hasPending)
+    {
+        int32_t mm = Radar_ProcessSample(pendingAngle, pendingMm);
+        hit |= (mm > 0 && mm < ADAPT_TARGET_CM * 10 && Bg_IsForeground(Frame_BinIndex(pendingAngle)));
+        alarm |= (mm > 0 && mm <= WARNING_DISTANCE_MM);
+    }
+    Sector_UpdateInterest(sector, hit, alarm);
+    return samples;
+}
+
+/* 雷达扫描任务
+ * 流水线：舵机按运动模型预测的时间稳定后触发本角度测距，在回波往返期间处理上一角度的样本，
+ * 回波一到立即转向下一角度，因此每个角度都有新鲜的距离值。
+ * 端点角度的样本处理完即一次扫描结束，此时发布扫描帧。
+ */
 static void Radar_ScanTask(void *arg)
 {
     (void)arg;
     uint16_t currentAngle = 90;
     int8_t direction = 1;
-
-    // 初始设置舵机角度
-    set_sg90_angle(currentAngle);
+    uint8_t hasPending = 0;
+    uint8_t pendingEndsSweep = 0;
+    uint16_t pendingAngle = 0;
+    int32_t pendingMm = -1;
+    uint32_t lastPingUs = hi_get_us();
+    uint32_t sweepStartUs = lastPingUs;
+    uint32_t sweepSamples = 0;
+    uint32_t coveredSectors = 0; // 自适应扫描本轮已访问的扇区
+
+    // 初始设置舵机角度 (上电位置未知，固定等待)
+    Servo_Move(currentAngle);
     usleep(200 * 1000);
+    Frame_Begin(Frame_Alloc(), direction);
+    g_contServoTimer = osTimerNew(Radar_ContServoTick, osTimerPeriodic, NULL, NULL);
 
     while (1)
     {
         // 检查扫描是否启用
-        if (!g_scanEnabled)
+        if (!g_state.scanEnabled)
         {
+            hasPending = 0;
+            sweepSamples = 0;
+            sweepStartUs = hi_get_us();
+            coveredSectors = 0;
+            g_sectorLast = -1;
+            memset(g_sectorSeenMs, 0, sizeof(g_sectorSeenMs)); // 暂停时间不计入访问间隔
             usleep(50 * 1000);
             continue;
         }
 
-        // 1. 舵机动作
-        set_sg90_angle(currentAngle);
-        usleep(20 * 1000);
-
-        // 2. 预读取传感器
-        float rawDist = -1.0f;
-        if (g_distanceUpdateCounter >= 9)
+        // 舵机标定请求 (MQTT 下发)，在扫描任务里执行以独占舵机与测距
+        if (g_bgResetRequest)
         {
-            rawDist = sr04_read_distance();
+            g_bgResetRequest = 0;
+            Bg_Reset();
         }
-
-        // 获取互斥锁
-        osMutexAcquire(g_systemMutex, osWaitForever);
-
-        if (!g_scanEnabled)
+        if (g_servoCalRequest)
         {
-            osMutexRelease(g_systemMutex);
-            usleep(10 * 1000);
-            continue;
+            uint32_t calStartUs = hi_get_us();
+            g_servoCalRequest = 0;
+            Servo_Calibrate();
+            sweepStartUs += hi_get_us() - calStartUs;
         }
 
-        g_currentAngle = currentAngle;
-        g_distanceUpdateCounter++;
-
-        if (g_distanceUpdateCounter >= 10)
+        // 连续扫描：一趟在 Radar_ContinuousSweep 内完成，结束后停在端点
+        if (g_scanStrategy == SCAN_CONTINUOUS)
         {
-            // 数据滤波逻辑
-            if (rawDist >= 0)
+            if (hasPending)
             {
-                float validDist = rawDist;
-                // 限幅 + 突变抑制
-                if (rawDist <= 0 || rawDist >= 400)
-                {
-                    validDist = g_currentDistance;
-                }
-                else if (g_currentDistance > 0 &&
-                         (rawDist > g_currentDistance + 50 || rawDist < g_currentDistance - 50))
+                Radar_ProcessSample(pendingAngle, pendingMm);
+                hasPending = 0;
+                if (pendingEndsSweep)
                 {
-                    validDist = g_currentDistance;
+                    Frame_Publish(direction);
+                    Radar_SweepDone(sweepSamples, sweepStartUs);
+                    sweepSamples = 0;
+                    sweepStartUs = hi_get_us();
                 }
-                // 滑动平均
-                if (g_currentDistance == 0)
-                    g_currentDistance = validDist;
-                else
-                    g_currentDistance = g_currentDistance * 0.7f + validDist * 0.3f;
             }
+            sweepSamples += Radar_ContinuousSweep(direction);
+            if (g_servoTarget == SCAN_END_ANGLE || g_servoTarget == SCAN_START_ANGLE)
+            {
+                direction = (g_servoTarget == SCAN_END_ANGLE) ? -1 : 1;
+                Frame_Publish(direction);
+                Radar_SweepDone(sweepSamples, sweepStartUs);
+                sweepSamples = 0;
+                sweepStartUs = hi_get_us();
+            }
+            // 中途切回逐步扫描时从当前位置所在的步进格继续
+            currentAngle = g_servoTarget - (g_servoTarget - SCAN_START_ANGLE) % SCAN_STEP_ANGLE;
+            lastPingUs = hi_get_us();
+            continue;
+        }
+
+        // 自适应扫描：每次访问一个扇区并发布一帧；所有扇区都访问过一轮记为一次扫描
+        if (g_scanStrategy == SCAN_ADAPTIVE)
+        {
+            if (hasPending)
+            {
+                Radar_ProcessSample(pendingAngle, pendingMm);
+                hasPending = 0;
+            }
+            uint8_t coarse = 0;
+            int sector = Sector_Schedule(&coarse);
+            sweepSamples += Radar_AdaptivePass(sector, coarse, &lastPingUs);
+            Frame_Publish(direction);
+            coveredSectors |= 1u << sector;
+            if (coveredSectors == (1u << ADAPT_SECTOR_COUNT) - 1)
+            {
+                Radar_SweepDone(sweepSamples, sweepStartUs);
+                coveredSectors = 0;
+                sweepSamples = 0;
+                sweepStartUs = hi_get_us();
+            }
+            currentAngle = g_servoTarget - (g_servoTarget - SCAN_START_ANGLE) % SCAN_STEP_ANGLE;
+            continue;
+        }
+        coveredSectors = 0;
 
-            g_distanceUpdateCounter = 0;
-            g_alarmState = Get_AlarmState(g_currentDistance);
-            Alarm_Control(g_alarmState);
+        // 1. 舵机动作
+        Servo_Move(currentAngle);
 
-            // 只有在这里显式确认状态
-            if (g_alarmState == ALARM_DANGER)
-                g_systemState = SYSTEM_ALARM;
-            else
-                g_systemState = SYSTEM_SCANNING;
+        // 2. 舵机稳定后触发本角度测距 (原设计每 10 步才测一次)
+        uint8_t doPing = 1;
+        if (g_rangingMode == RANGING_DECIMATED)
+        {
+            doPing = (++g_distanceUpdateCounter >= 10);
+            if (doPing)
+                g_distanceUpdateCounter = 0;
+        }
+        if (doPing)
+        {
+            uint32_t readyUs = g_servoReadyUs;
+            if ((int32_t)(lastPingUs + Sr04Async_GapUs() - readyUs) > 0)
+                readyUs = lastPingUs + Sr04Async_GapUs();
+            Radar_WaitUntil(readyUs);
+            Sr04Async_Trigger();
+        }
+        else
+        {
+            Radar_WaitUntil(g_servoReadyUs);
+        }
 
-            // 发送数据到队列
-            if (g_dataQueue != NULL)
+        // 3. 回波在途期间处理上一角度的样本
+        if (hasPending)
+        {
+            Radar_ProcessSample(pendingAngle, pendingMm);
+            hasPending = 0;
+            if (pendingEndsSweep)
             {
-                RadarData_t sendData;
-                sendData.distance = g_currentDistance;
-                sendData.angle = currentAngle;
-                sendData.alarmState = g_alarmState;
-                sendData.sysState = g_systemState;
-                osMessageQueuePut(g_dataQueue, &sendData, 0, 0);
+                Frame_Publish(direction);
+                Radar_SweepDone(sweepSamples, sweepStartUs);
+                sweepSamples = 0;
+                sweepStartUs = hi_get_us();
             }
         }
-        osMutexRelease(g_systemMutex);
+
+        // 4. 阻塞等待回波，期间 CPU 让给其他任务
+        int32_t rawMm = -1;
+        if (doPing)
+        {
+            rawMm = Sr04Async_Wait();
+            lastPingUs = hi_get_us();
+            sweepSamples++;
+        }
+        pendingAngle = currentAngle;
+        pendingMm = rawMm;
+        pendingEndsSweep = (currentAngle == SCAN_END_ANGLE || currentAngle == SCAN_START_ANGLE);
+        hasPending = 1;
+
+        // 原设计的步间延时，仅在抽样模式下保留以便对比
+        if (g_rangingMode == RANGING_DECIMATED)
+            usleep(10 * 1000);
 
         // 角度步进
         if (direction > 0)
@@ -372,8 +3404,6 @@ static void Radar_ScanTask(void *arg)
                 currentAngle = SCAN_START_ANGLE;
             }
         }
-
-        usleep(10 * 1000);
     }
 }
 
@@ -381,87 +3411,49 @@ static void Radar_ScanTask(void *arg)
 static void OLED_DisplayTask(void *arg)
 {
     (void)arg;
-    RadarData_t recvData = {0};
-    static char displayBuffer[32];
-    static uint8_t radar_history[37] = {0};
+    RadarState_t st = {0};
+    uint32_t drawnSeq = 0;
+    const RadarFrame_t *frame = NULL;
 
     printf("OLED显示任务启动\n");
-    oled_clear();
-    oled_refresh_gram();
+    Frame_Attach(FRAME_CONSUMER_DISPLAY);
+    Oled_Init();
+    Compose_Build();
 
     while (1)
     {
-        // 尝试获取数据
-        int hasNewData = 0;
-        RadarData_t tempData;
-        while (osMessageQueueGet(g_dataQueue, &tempData, NULL, 0) == osOK)
+        // 状态快照的序号变了 (扫描任务发布过新样本或启停) 才重画；
+        // 当前角度与距离直接取快照，不经队列拷贝
+        uint32_t seq = State_Read(&st);
+        if (seq == drawnSeq)
         {
-            recvData = tempData;
-            hasNewData = 1;
-        }
-        if (!hasNewData)
-        {
-            if (osMessageQueueGet(g_dataQueue, &recvData, NULL, 100) == osOK)
-            {
-                hasNewData = 1;
-            }
+            osEventFlagsWait(g_oledEvent, OLED_EVT_STATE, osFlagsWaitAny, 100);
+            seq = State_Read(&st);
         }
+        int hasNewData = (seq != drawnSeq);
+        drawnSeq = seq;
 
         if (hasNewData)
         {
-            // 更新历史数组
-            int angle_idx = recvData.angle / 5;
-            if (angle_idx >= 0 && angle_idx <= 36)
+            // 有新扫描帧时换用新帧，旧帧归还帧池
+            const RadarFrame_t *fresh = Frame_Receive(FRAME_CONSUMER_DISPLAY, 0);
+            if (fresh != NULL)
             {
-                radar_history[angle_idx] = (recvData.distance > 0 && recvData.distance < 100) ? (uint8_t)recvData.distance : 0;
+                Frame_Release(frame);
+                frame = fresh;
             }
 
-            oled_fill(0, 16, 127, 63, 0);
-
-            // 显示状态
-            uint8_t *statusText;
-            if (recvData.alarmState == ALARM_DANGER)
-                statusText = (uint8_t *)"ALARM";
-            else if (recvData.alarmState == ALARM_WARNING)
-                statusText = (uint8_t *)"WARN ";
+            // 合成到后台缓冲，交换后由传输任务只发送与面板不同的字节
+            uint32_t drawStart = Bench_Cycles();
+            OledStatus_t status;
+            if (st.alarmState == ALARM_DANGER)
+                status = OLED_STATUS_ALARM;
+            else if (st.alarmState == ALARM_WARNING)
+                status = OLED_STATUS_WARN;
             else
-                statusText = (recvData.sysState == SYSTEM_SCANNING) ? (uint8_t *)"SCAN " : (uint8_t *)"STOP ";
-            oled_showstring(0, 0, statusText, 16);
-
-            // 显示数值
-            snprintf(displayBuffer, sizeof(displayBuffer), "%-3d^%-3.0fcm", recvData.angle, recvData.distance);
-            oled_showstring(42, 0, (uint8_t *)displayBuffer, 16);
-
-            // 绘制扫描线
-            float cos_val = GetCos(recvData.angle);
-            float sin_val = GetSin(recvData.angle);
-            int x_end = 64 + (int)(45 * cos_val);
-            int y_end = 63 - (int)(45 * sin_val);
-            if (x_end < 0)
-                x_end = 0;
-            if (x_end > 127)
-                x_end = 127;
-            if (y_end < 16)
-                y_end = 16;
-            if (y_end > 63)
-                y_end = 63;
-            oled_drawline(64, 63, x_end, y_end, 1);
-
-            // 绘制历史点 (轨迹)
-            for (int i = 0; i <= 36; i++)
-            {
-                if (radar_history[i] > 0)
-                {
-                    int h_angle = i * 5;
-                    float h_cos = GetCos(h_angle);
-                    float h_sin = GetSin(h_angle);
-                    int r_obj = (int)((radar_history[i] / 100.0f) * 45);
-                    int x_obj = 64 + (int)(r_obj * h_cos);
-                    int y_obj = 63 - (int)(r_obj * h_sin);
-                    oled_draw_bigpoint(x_obj, y_obj, 1);
-                }
-            }
-            oled_refresh_gram();
+                status = (st.sysState == SYSTEM_SCANNING) ? OLED_STATUS_SCAN : OLED_STATUS_STOP;
+            Compose_Frame(&st, frame, status);
+            Oled_EndFrame(drawStart);
         }
         else
         {
@@ -470,8 +3462,8 @@ static void OLED_DisplayTask(void *arg)
             uint32_t currentTime = osKernelGetTickCount();
             if (currentTime - lastUpdate > 1000)
             {
-                oled_showstring(0, 0, g_scanEnabled ? (uint8_t *)"SCAN " : (uint8_t *)"STOP ", 16);
-                oled_refresh_gram();
+                Compose_Frame(&st, frame, st.scanEnabled ? OLED_STATUS_SCAN : OLED_STATUS_STOP);
+                Oled_Swap();
                 lastUpdate = currentTime;
             }
         }
@@ -479,6 +3471,51 @@ static void OLED_DisplayTask(void *arg)
     }
 }
 
+/* 帧日志任务：每帧一行摘要，定期打印分发统计 */
+static void Frame_LogTask(void *arg)
+{
+    (void)arg;
+    Frame_Attach(FRAME_CONSUMER_LOG);
+    while (1)
+    {
+        const RadarFrame_t *frame = Frame_Receive(FRAME_CONSUMER_LOG, osWaitForever);
+        if (frame == NULL)
+            continue;
+        int targets = 0;
+        for (int i = 0; i < RADAR_FRAME_BINS; i++)
+            targets += (frame->rangeMm[i] > 0);
+        int nearest = Frame_Nearest(frame, 0);
+        printf("[Frame] #%u %s %u ms, %d/%d bins hit, %u foreground, %u objects, nearest %u mm @%d\n", frame->seq,
+               frame->direction > 0 ? "up" : "down", frame->endMs - frame->startMs, targets, RADAR_FRAME_BINS,
+               frame->fgCount, frame->objectCount,
+               nearest < 0 ? 0 : frame->rangeMm[nearest],
+               nearest < 0 ? -1 : SCAN_START_ANGLE + nearest * RADAR_ANGLE_RES_DEG);
+        for (int i = 0; i < frame->objectCount; i++)
+        {
+            const RadarObject_t *o = &frame->objects[i];
+            if (o->ttcMs != TTC_NONE)
+                printf("[Track] #%u @%u deg %u mm, closing %d mm/s, TTC %u ms\n", o->id, o->bearing, o->rangeMm,
+                       -o->velMmS, o->ttcMs);
+        }
+        if (frame->seq % FRAME_LOG_EVERY == 0)
+        {
+            Frame_PrintStats();
+            Sector_PrintStats();
+            Alarm_PrintStats();
+            Bg_PrintStats();
+            Sweep_PrintStats();
+            Render_PrintStats();
+            const StateLockStats_t *ls = &g_stateLockStats;
+            printf("[State] lock %u, contended %u, wait %u us (max %u us), read retries %u\n", ls->acquires,
+                   ls->contended, ls->waitUs, ls->maxWaitUs, ls->readRetries);
+            const Sr04Stats_t *ss = &g_sr04Stats;
+            printf("[SR04] pings %u, echoes %u, no echo %u, timeouts %u, busy %u, in flight %u ms\n", ss->pings,
+                   ss->echoes, ss->noEcho, ss->timeouts, ss->busyWaits, ss->flightUs / 1000);
+        }
+        Frame_Release(frame);
+    }
+}
+
 /* ============================================================
  * 网络通信任务 (仅负责 MQTT，不再有 WebServer)
  * ============================================================ */
@@ -489,134 +3526,166 @@ static int8_t MQTT_SubCallback(unsigned char *topic, unsigned char *payload)
     printf("[MQTT Recv] Topic:%s Payload:%s\n", topic, payload);
     if (strstr((char *)topic, "control"))
     {
-        osMutexAcquire(g_systemMutex, 100);
         if (strstr((char *)payload, "STOP"))
         {
-            g_scanEnabled = 0;
-            g_systemState = SYSTEM_STOPPED;
-            set_sg90_angle(90);
+            State_SetScanEnabled(0);
+            return 0;
         }
-        else if (strstr((char *)payload, "START"))
+        if (strstr((char *)payload, "START"))
         {
-            g_scanEnabled = 1;
-            g_systemState = SYSTEM_SCANNING;
+            State_SetScanEnabled(1);
+            return 0;
         }
-        osMutexRelease(g_systemMutex);
-    }
-    return 0;
-}
 
-/* MQTT 接收线程 */
-static void MQTT_RecvLoopTask(void)
-{
-    while (1)
-    {
-        MQTTClient_sub();
-        usleep(200 * 1000);
+        // 滤波器组与扫描任务共用写者锁
+        State_Lock();
+        if (strstr((char *)payload, "MODE:DECIMATED"))
+        {
+            g_rangingMode = RANGING_DECIMATED;
+        }
+        else if (strstr((char *)payload, "MODE:PIPELINED"))
+        {
+            g_rangingMode = RANGING_PIPELINED;
+        }
+        else if (strstr((char *)payload, "GATE:NEAR"))
+        {
+            g_rangeGate = GATE_NEAR;
+        }
+        else if (strstr((char *)payload, "GATE:SURVEY"))
+        {
+            g_rangeGate = GATE_SURVEY;
+        }
+        else if (strstr((char *)payload, "SCAN:STEP"))
+        {
+            g_scanStrategy = SCAN_STEP;
+        }
+        else if (strstr((char *)payload, "SCAN:CONT"))
+        {
+            g_scanStrategy = SCAN_CONTINUOUS;
+        }
+        else if (strstr((char *)payload, "SCAN:ADAPT"))
+        {
+            g_scanStrategy = SCAN_ADAPTIVE;
+        }
+        else if (strstr((char *)payload, "BG:ON"))
+        {
+            g_bgEnabled = 1;
+        }
+        else if (strstr((char *)payload, "BG:OFF"))
+        {
+            g_bgEnabled = 0;
+        }
+        else if (strstr((char *)payload, "BG:RESET"))
+        {
+            g_bgResetRequest = 1;
+        }
+        else if (strstr((char *)payload, "FORMAT:JSON"))
+        {
+            g_sweepFormat = SWEEP_FORMAT_JSON;
+        }
+        else if (strstr((char *)payload, "FORMAT:BIN"))
+        {
+            g_sweepFormat = SWEEP_FORMAT_BINARY;
+            g_sweepKeyRequest = 1;
+        }
+        else if (strstr((char *)payload, "RATE:"))
+        {
+            g_sweepMinIntervalMs = (uint32_t)atoi(strstr((char *)payload, "RATE:") + 5);
+        }
+        else if (strstr((char *)payload, "CAL:SERVO"))
+        {
+            g_servoCalRequest = 1;
+        }
+        else if (strstr((char *)payload, "FILTER:MEDIAN"))
+        {
+            g_filterMode = FILTER_MEDIAN;
+            Filter_Reset();
+        }
+        else if (strstr((char *)payload, "FILTER:AB"))
+        {
+            g_filterMode = FILTER_ALPHA_BETA;
+            Filter_Reset();
+        }
+        State_Unlock();
     }
+    return 0;
 }
 
-/* 核心网络任务: 负责连接WiFi并建立MQTT连接 */
-static void WiFi_MQTT_Task(void *arg)
+/* 整帧上报任务：WiFi 与 MQTT 会话由网络服务负责 (见 common/net_service.h)，这里只把扫描帧编码后入队 */
+static void MQTT_SweepTask(void *arg)
 {
     (void)arg;
-    char payload[128];
-
-    printf("WiFi/MQTT Task Started...\n");
-
-    // 1. 连接WiFi
-    printf("Connecting to WiFi: %s...\n", WIFI_SSID);
-    WifiErrorCode wifi_res = WiFi_connectHotspots(WIFI_SSID, WIFI_PAWD);
-    if (wifi_res != WIFI_SUCCESS)
-    {
-        printf("WiFi Connect Error: %d\n", wifi_res);
-    }
-
-    // 等待获取IP (静默等待，不打印IP)
-    int wait_count = 0;
-    int is_connected = 0;
-    while (wait_count < 20)
-    {
-        char *ip = WiFi_GetLocalIP();
-        if (ip && strlen(ip) > 0 && strcmp(ip, "EC800M_4G") != 0 && strcmp(ip, "0.0.0.0") != 0)
-        {
-            printf("WiFi Connected Successfully.\n");
-            is_connected = 1;
-            break;
-        }
-        sleep(1);
-        wait_count++;
-    }
+    char payload[MQTT_SWEEP_PAYLOAD];
 
-    if (!is_connected)
+    if (NetService_WaitUp(osWaitForever) != 0)
     {
-        printf("WiFi connection timeout!\n");
-        // 显示连接失败信息到 OLED (可选)
-        osMutexAcquire(g_systemMutex, 100);
-        oled_clear();
-        oled_showstring(0, 0, (uint8_t *)"WiFi Failed", 16);
-        oled_refresh_gram();
-        osMutexRelease(g_systemMutex);
-
-        // 即使没有网络，也保持线程运行，防止系统Crash
+        // 连接失败提示由显示任务按网络服务状态绘制
+        printf("MQTT Failed to Connect.\n");
         while (1)
-        {
             sleep(10);
-        }
     }
 
-    // 2. 连接 MQTT 服务器
-    printf("Connecting to MQTT Server...\n");
-    int retry = 0;
-    while (retry < 5)
+    // 数据上报循环：每个扫描帧整帧上报一次 (不超过限速)；
+    // 背景模型启用时，只有静态背景的帧按心跳间隔上报
+    Frame_Attach(FRAME_CONSUMER_MQTT);
+    uint32_t quietFrames = 0;
+    uint32_t lastPubMs = 0;
+    while (1)
     {
-        if (MQTTClient_connectServer(SERVER_IP_ADDR, SERVER_IP_PORT) == 0)
+        const RadarFrame_t *frame = Frame_Receive(FRAME_CONSUMER_MQTT, osWaitForever);
+        if (frame == NULL)
+            continue;
+        RadarState_t st;
+        State_Read(&st);
+        SweepPubStats_t *ps = &g_sweepPubStats;
+        ps->frames++;
+        uint8_t quiet = g_bgEnabled && frame->fgCount == 0 && frame->objectCount == 0;
+        uint32_t now = hi_get_milli_seconds();
+        if (st.scanEnabled && quiet && ++quietFrames % BG_MQTT_HEARTBEAT != 0)
         {
-            printf("MQTT Server Connected!\n");
-            break;
+            g_bgStats.mqttSkipped++;
         }
-        printf("MQTT Connect Failed, Retrying...\n");
-        sleep(2);
-        retry++;
-    }
-
-    if (retry < 5)
-    {
-        // 初始化 MQTT
-        if (MQTTClient_init("hi3861_radar_pro", "user", "pass") == 0)
+        else if (st.scanEnabled && ps->published > 0 && now - lastPubMs < g_sweepMinIntervalMs)
         {
-            // 订阅主题
-            p_MQTTClient_sub_callback = &MQTT_SubCallback;
-            MQTTClient_subscribe(MQTT_TOPIC_CONTROL);
-
-            // 启动接收子线程
-            osThreadAttr_t attr = {0};
-            attr.name = "MQTT_RecvLoop";
-            attr.stack_size = 4096;
-            attr.priority = osPriorityNormal;
-            osThreadNew((osThreadFunc_t)MQTT_RecvLoopTask, NULL, &attr);
-
-            // 数据上报循环
-            while (1)
+            ps->rateSkipped++;
+        }
+        else if (st.scanEnabled)
+        {
+            if (!quiet)
+                quietFrames = 0;
+            int len;
+            uint8_t pubFlags = 0;
+            if (g_sweepFormat == SWEEP_FORMAT_BINARY)
             {
-                if (g_scanEnabled)
+                uint8_t key = g_sweepKeyRequest || ps->published % MQTT_SWEEP_KEY_EVERY == 0;
+                pubFlags = key ? 0 : MQTT_PUBQ_F_CHAIN;
+                g_sweepKeyRequest = 0;
+                len = Sweep_Encode(frame, &st, key ? NULL : g_sweepBaseMm, g_sweepBaseSeq, (uint8_t *)payload);
+                memcpy(g_sweepBaseMm, frame->rangeMm, sizeof(g_sweepBaseMm));
+                g_sweepBaseSeq = frame->seq;
+                ps->keyframes += key;
+            }
+            else
+            {
+                len = Sweep_Format(frame, &st, payload, sizeof(payload));
+                if (len == 0)
                 {
-                    snprintf(payload, sizeof(payload),
-                             "{\"angle\":%d,\"dist\":%.1f,\"state\":%d}",
-                             g_currentAngle, g_currentDistance, g_systemState);
-                    MQTTClient_pub(MQTT_TOPIC_DATA, (unsigned char *)payload, strlen(payload));
+                    Frame_Release(frame);
+                    continue;
                 }
-                sleep(1); // 1秒上报一次，防止拥塞
             }
+            // 差分帧带 CHAIN：队列丢了旧帧时会连带清掉排在后面、已解不出来的差分帧，
+            // 本帧也会被拒；丢帧或被拒都说明基准链已断，下一帧发关键帧
+            if (NetService_Publish(MQTT_TOPIC_DATA, (const uint8_t *)payload, (size_t)len, pubFlags) != 0)
+                g_sweepKeyRequest = 1;
+            lastPubMs = now;
+            ps->published++;
+            ps->bytes += (uint32_t)len;
+            if ((uint32_t)len > ps->bytesMax)
+                ps->bytesMax = (uint32_t)len;
         }
+        Frame_Release(frame);
     }
-    else
-    {
-        printf("MQTT Failed to Connect.\n");
-    }
-
-    while (1)
-        sleep(10);
 }
 
 /* ============================================================
@@ -628,19 +3697,41 @@ static void UltrasonicRadarApp(void)
 
     // 1. 初始化硬件
     System_Init();
-
-    // 2. 启动网络任务 (WiFi + MQTT)
+#if RADAR_BENCH
+    Bench_Run();
+#endif
+
+    // 2. 启动网络服务 (WiFi + MQTT 会话与收发，可与其他模块共用) 和整帧上报任务
+    NetService_Subscribe(MQTT_TOPIC_CONTROL, &MQTT_SubCallback);
+    NetServiceConfig_t net_cfg = {
+        .ssid = WIFI_SSID,
+        .password = WIFI_PAWD,
+        .serverIp = SERVER_IP_ADDR,
+        .serverPort = SERVER_IP_PORT,
+        .clientId = "hi3861_radar_pro",
+        .userName = "user",
+        .userPassword = "pass",
+        .pubPolicy = MQTT_PUB_DROP_POLICY};
+    if (NetService_Start(&net_cfg) != 0)
+        printf("NetService start failed!\n");
     osThreadAttr_t mqtt_attr = {
-        .name = "WiFi_MQTT_Task",
-        .stack_size = 8192,
+        .name = "MQTT_SweepTask",
+        .stack_size = 3072 + MQTT_SWEEP_PAYLOAD, // 上报缓冲在栈上
         .priority = osPriorityAboveNormal};
-    g_mqttTaskHandle = osThreadNew(WiFi_MQTT_Task, NULL, &mqtt_attr);
+    g_mqttTaskHandle = osThreadNew(MQTT_SweepTask, NULL, &mqtt_attr);
 
     // 给网络任务一点时间
     usleep(100 * 1000);
 
     // 3. 启动应用逻辑任务
 
+    // 告警任务 (最高优先级，回波中断置位后立即驱动蜂鸣器)
+    osThreadAttr_t alarm_attr = {
+        .name = "AlarmTask",
+        .stack_size = 1024,
+        .priority = osPriorityHigh};
+    osThreadNew(Alarm_Task, NULL, &alarm_attr);
+
     // 按键任务
     osThreadAttr_t key_attr = {
         .name = "KeyScanTask",
@@ -648,11 +3739,12 @@ static void UltrasonicRadarApp(void)
         .priority = osPriorityNormal};
     osThreadNew(Key_ScanTask, NULL, &key_attr);
 
-    // 雷达扫描任务
+    // 雷达扫描任务 (高于显示任务：大部分时间阻塞在回波/稳定等待上，
+    // 醒来后需立即处理，否则要等同优先级的显示任务用完时间片)
     osThreadAttr_t scan_attr = {
         .name = "RadarScanTask",
         .stack_size = 5120,
-        .priority = osPriorityNormal};
+        .priority = osPriorityNormal1};
     g_scanTaskHandle = osThreadNew(Radar_ScanTask, NULL, &scan_attr);
 
     // OLED 显示任务
@@ -662,6 +3754,20 @@ static void UltrasonicRadarApp(void)
         .priority = osPriorityNormal};
     g_displayTaskHandle = osThreadNew(OLED_DisplayTask, NULL, &display_attr);
 
+    // OLED 传输任务 (低于显示任务：I2C 传输只占用空闲时间，绘制下一帧不必等它)
+    osThreadAttr_t oled_tx_attr = {
+        .name = "OLEDTxTask",
+        .stack_size = 1024,
+        .priority = osPriorityBelowNormal};
+    osThreadNew(Oled_TxTask, NULL, &oled_tx_attr);
+
+    // 扫描帧日志任务
+    osThreadAttr_t log_attr = {
+        .name = "FrameLogTask",
+        .stack_size = 2048,
+        .priority = osPriorityBelowNormal};
+    osThreadNew(Frame_LogTask, NULL, &log_attr);
+
     printf("=== System Running ===\n");
 }
 
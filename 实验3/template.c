@@ -30,13 +30,13 @@
 #include "bsp_led.h"
 #include "bsp_pwm.h"
 #include "bsp_adc.h"
-#include "bsp_wifi.h"
-#include "bsp_mqtt.h"
 
 #include "lwip/netifapi.h"
 #include "lwip/sockets.h"
 #include "lwip/api_shell.h"
 
+#include "net_service.h" // common/：WiFi/MQTT 会话、主题路由与收发由共用的网络服务负责
+
 // ========================= 配置区域 =========================
 // WiFi 热点配置（改成你的手机热点名称和密码）
 #ifndef WIFI_SSID
@@ -64,18 +64,16 @@
 #define MQTT_TOPIC_SUB_BRIGHTNESS "hi3861/led/brightness"
 #endif
 
-// 发布与订阅任务时间间隔
-#define TASK_INIT_DELAY_S 2                     // seconds，初始化阶段各环节的间隔
-#define MQTT_RECV_TASK_INTERVAL_US (200 * 1000) // 接收轮询间隔
-#define LIGHT_PUB_INTERVAL_S 2                  // 光照上报间隔
+// 上报任务
+#define LIGHT_PUB_INTERVAL_S 2       // seconds，光照上报间隔
+#define LIGHT_TASK_STACK (1024 * 2) // 只采样与格式化，网络收发不在本任务
 
 // PWM 占空比范围（参考实验16）
 #define PWM_DUTY_MIN 0
 #define PWM_DUTY_MAX 3000
 
 // ========================= 任务与句柄 =========================
-static osThreadId_t g_mqtt_send_task_id; // MQTT发布与系统初始化任务
-static osThreadId_t g_mqtt_recv_task_id; // MQTT订阅接收轮询任务
+static osThreadId_t g_light_task_id; // 外设初始化与光照上报任务
 
 // ========================= 工具函数 =========================
 // 将 0-100 的亮度映射到 PWM 占空比 0-3000
@@ -147,19 +145,8 @@ int8_t mqtt_sub_payload_callback(unsigned char *topic, unsigned char *payload)
     return 0;
 }
 
-// ========================= 接收轮询任务 =========================
-static void mqtt_recv_task(void)
-{
-    while (1)
-    {
-        // 驱动内部轮询并触发回调（参考实验26）
-        MQTTClient_sub();
-        usleep(MQTT_RECV_TASK_INTERVAL_US);
-    }
-}
-
-// ========================= 发送与系统初始化任务 =========================
-static void mqtt_send_task(void)
+// ========================= 初始化与上报任务 =========================
+static void light_task(void)
 {
     // 1. 基础外设初始化：LED、PWM、ADC
     led_init();
@@ -170,72 +157,18 @@ static void mqtt_send_task(void)
     pwm_set_duty(BrightnessToDuty(10));
     LED(1);
 
-    // 2. 连接 WiFi
-    if (WiFi_connectHotspots(WIFI_SSID, WIFI_PAWD) != WIFI_SUCCESS)
-    {
-        printf("[error] WiFi_connectHotspots\r\n");
-    }
-    else
+    // 2. 等待 WiFi 与 MQTT 会话建立 (网络服务已在入口里启动)
+    if (NetService_WaitUp(osWaitForever) != 0)
     {
-        printf("[success] WiFi connected: SSID=%s\r\n", WIFI_SSID);
-    }
-
-    sleep(TASK_INIT_DELAY_S);
-
-    // 3. 连接 MQTT 服务器
-    if (MQTTClient_connectServer(MQTT_SERVER_IP, MQTT_SERVER_PORT) != 0)
-    {
-        printf("[error] MQTTClient_connectServer\r\n");
-    }
-    else
-    {
-        printf("[success] MQTTClient_connectServer\r\n");
-    }
-
-    sleep(TASK_INIT_DELAY_S);
-
-    // 4. 初始化 MQTT 客户端
-    if (MQTTClient_init("hi3861_client", "username", "password") != 0)
-    {
-        printf("[error] MQTTClient_init\r\n");
-    }
-    else
-    {
-        printf("[success] MQTTClient_init\r\n");
-    }
-
-    sleep(TASK_INIT_DELAY_S);
-
-    // 5. 设置订阅回调并订阅亮度控制主题
-    p_MQTTClient_sub_callback = &mqtt_sub_payload_callback;
-    if (MQTTClient_subscribe(MQTT_TOPIC_SUB_BRIGHTNESS) != 0)
-    {
-        printf("[error] MQTTClient_subscribe:%s\r\n", MQTT_TOPIC_SUB_BRIGHTNESS);
-    }
-    else
-    {
-        printf("[success] MQTTClient_subscribe:%s\r\n", MQTT_TOPIC_SUB_BRIGHTNESS);
-    }
-
-    sleep(TASK_INIT_DELAY_S);
-
-    // 6. 创建接收轮询任务
-    osThreadAttr_t recvOpt;
-    recvOpt.name = "mqtt_recv_task";
-    recvOpt.attr_bits = 0;
-    recvOpt.cb_mem = NULL;
-    recvOpt.cb_size = 0;
-    recvOpt.stack_mem = NULL;
-    recvOpt.stack_size = 1024 * 5;
-    recvOpt.priority = osPriorityNormal;
-
-    g_mqtt_recv_task_id = osThreadNew((osThreadFunc_t)mqtt_recv_task, NULL, &recvOpt);
-    if (g_mqtt_recv_task_id != NULL)
-    {
-        printf("ID = %d, Create mqtt_recv_task OK!\r\n", g_mqtt_recv_task_id);
+        printf("[error] NetService: WiFi/MQTT unavailable\r\n");
+        while (1)
+        {
+            sleep(10);
+        }
     }
+    printf("[success] NetService up, subscribed:%s\r\n", MQTT_TOPIC_SUB_BRIGHTNESS);
 
-    // 7. 周期性读取光照并发布
+    // 3. 周期性读取光照并发布
     char msgBuf[64];
     while (1)
     {
@@ -245,8 +178,15 @@ static void mqtt_send_task(void)
         if (len < 0)
             len = 0;
 
-        MQTTClient_pub(MQTT_TOPIC_PUB_LIGHT, msgBuf, (size_t)len);
-        printf("[pub] %s => %s\r\n", MQTT_TOPIC_PUB_LIGHT, msgBuf);
+        // 入队即返回，网络阻塞不会拖慢采样
+        if (NetService_Publish(MQTT_TOPIC_PUB_LIGHT, (const uint8_t *)msgBuf, (size_t)len, 0) < 0)
+        {
+            printf("[warn] publish queue full, drop %s\r\n", msgBuf);
+        }
+        else
+        {
+            printf("[pub] %s => %s\r\n", MQTT_TOPIC_PUB_LIGHT, msgBuf);
+        }
 
         sleep(LIGHT_PUB_INTERVAL_S);
     }
@@ -255,19 +195,19 @@ static void mqtt_send_task(void)
 // ========================= 任务创建 =========================
 static void wifi_light_mqtt_task_create(void)
 {
-    osThreadAttr_t sendOpt;
-    sendOpt.name = "mqtt_send_task";
-    sendOpt.attr_bits = 0;
-    sendOpt.cb_mem = NULL;
-    sendOpt.cb_size = 0;
-    sendOpt.stack_mem = NULL;
-    sendOpt.stack_size = 1024 * 5;
-    sendOpt.priority = osPriorityNormal;
-
-    g_mqtt_send_task_id = osThreadNew((osThreadFunc_t)mqtt_send_task, NULL, &sendOpt);
-    if (g_mqtt_send_task_id != NULL)
+    osThreadAttr_t taskOpt;
+    taskOpt.name = "light_task";
+    taskOpt.attr_bits = 0;
+    taskOpt.cb_mem = NULL;
+    taskOpt.cb_size = 0;
+    taskOpt.stack_mem = NULL;
+    taskOpt.stack_size = LIGHT_TASK_STACK;
+    taskOpt.priority = osPriorityNormal;
+
+    g_light_task_id = osThreadNew((osThreadFunc_t)light_task, NULL, &taskOpt);
+    if (g_light_task_id != NULL)
     {
-        printf("ID = %d, mqtt_send_task Create OK!\n", g_mqtt_send_task_id);
+        printf("ID = %d, light_task Create OK!\n", g_light_task_id);
     }
 }
 
@@ -275,6 +215,27 @@ static void wifi_light_mqtt_task_create(void)
 static void template_demo(void)
 {
     printf("普中-Hi3861开发板——WiFi通信实验（MQTT控制LED亮度，上报光照）\r\n");
+
+    // 注册亮度控制主题，启动网络服务（须在入口里调用；同一镜像里其他模块已启动时直接复用）
+    if (NetService_Subscribe(MQTT_TOPIC_SUB_BRIGHTNESS, &mqtt_sub_payload_callback) != 0)
+    {
+        printf("[error] NetService_Subscribe:%s\r\n", MQTT_TOPIC_SUB_BRIGHTNESS);
+    }
+    NetServiceConfig_t netCfg = {
+        .ssid = WIFI_SSID,
+        .password = WIFI_PAWD,
+        .serverIp = MQTT_SERVER_IP,
+        .serverPort = MQTT_SERVER_PORT,
+        .clientId = "hi3861_client",
+        .userName = "username",
+        .userPassword = "password",
+        .pubPolicy = MQTT_PUBQ_DROP_OLDEST, // 光照只关心最新值，网络慢时丢最旧的
+    };
+    if (NetService_Start(&netCfg) != 0)
+    {
+        printf("[error] NetService_Start\r\n");
+    }
+
     wifi_light_mqtt_task_create();
 }
 